@@ -11,86 +11,16 @@
 #include <SFML/Graphics/VertexArray.hpp>
 #include <SFML/System/Vector2.hpp>
 #include <SFML/Window/Mouse.hpp>
+#include <algorithm>
+#include <cmath>
 #include <memory>
 #include <random>
 #include <sstream>
+#include <type_traits>
 #include <vector>
 
-static void yeild_mines(Game::Cells& cells, int w = 9, int h = 9, int count = 10, int x = 0, int y = 0);
-
 namespace Game {
 
-    void Cells::reveal(int px, int py) {
-        auto queue = std::vector<std::pair<int, int>>({{px, py}});
-        while (!queue.empty()) {
-            auto [x, y] = queue.back();
-            queue.pop_back();
-            if (x < 0 || x >= width || y < 0 || y >= height) {
-                continue;
-            }
-            auto& cell = _cells[y * width + x];
-            if (!cell.m_is_mine && cell.state != Cell::CellState::Uncovered) {
-                cell.update(Cell::CellState::Uncovered);
-                if (cell.m_mine_count > 0) {
-                    continue;
-                }
-                if (x-1 >= 0 && y-1 >= 0) {
-                    queue.push_back({x-1, y-1});
-                }
-                if (x >= 0 && y-1 >= 0) {
-                    queue.push_back({x, y-1});
-                }
-                if (x+1 < width && y-1 >= 0) {
-                    queue.push_back({x+1, y-1});
-                }
-                if (x-1 >= 0) {
-                    queue.push_back({x-1, y});
-                }
-                if (x+1 < width) {
-                    queue.push_back({x+1, y});
-                }
-                if (x-1 >= 0 && y+1 < height) {
-                    queue.push_back({x-1, y+1});
-                }
-                if (y+1 < height) {
-                    queue.push_back({x, y+1});
-                }
-                if (x+1 < width && y+1 < height) {
-                    queue.push_back({x+1, y+1});
-                }
-            }
-        }
-    }
-
-    Cells::Cells(int w, int h, sf::Rect<int> rect, int count)
-        : width(w), height(h), count(count), uncovered(w*h - count), flag_mine_count(0)
-    {
-        sf::Font font = Singleton::ResourceManager::getInstance().getFont();
-
-        if (w <=0 || h <= 0) {
-            throw std::invalid_argument("Invalid dimensions");
-        }
-        _cells.reserve(w * h);
-
-        int cell_width = rect.size.x / w;
-        int cell_height = rect.size.y / h;
-
-        sf::Vector2i origin = rect.position;
-        for (int y = 0; y < h; ++y) {
-            for (int x = 0; x < w; ++x) {
-                _cells.emplace_back(
-                    sf::Rect<int>(
-                        {origin.x + x * cell_width, origin.y + y * cell_height},
-                        {cell_width, cell_height}
-                    ),
-                    font,
-                    x, y,
-                    *this
-                );
-            }
-        }
-    }
-
     static const sf::Color BColor[2][3] = {
         {
             sf::Color(240, 240, 240),
@@ -104,31 +34,214 @@ namespace Game {
         },
     };
 
-    Cell::Cell(const sf::Rect<int>& rect, sf::Font& font, int x, int y, Cells& parent) 
-        : m_rect(std::make_shared<const sf::Rect<int>>(rect)),
-        vertices(sf::PrimitiveType::Triangles),
+    // 按原 Cell 的顶点布局追加一个格子，style 为 0 表示未翻开，1 表示已翻开
+    static void append_cell_vertices(sf::VertexArray& vertices, sf::Vector2f pos, sf::Vector2f size, float border, int style) {
+        const auto& color = BColor[style];
+        // 顶点布局：
+        // 0---1---2
+        // |  / |  / |
+        // | /  | /  |
+        // 3---4---5
+        vertices.append(sf::Vertex(pos + sf::Vector2f(0, 0), color[2]));
+        vertices.append(sf::Vertex(pos + sf::Vector2f(size.x, 0), color[2]));
+        vertices.append(sf::Vertex(pos + sf::Vector2f(size.x, size.y), color[2]));
+        vertices.append(sf::Vertex(pos + sf::Vector2f(0, 0), color[2]));
+        vertices.append(sf::Vertex(pos + sf::Vector2f(size.x, size.y), color[2]));
+        vertices.append(sf::Vertex(pos + sf::Vector2f(0, size.y), color[2]));
+
+        // 上边框
+        vertices.append(sf::Vertex(pos + sf::Vector2f(0, 0), color[0]));
+        vertices.append(sf::Vertex(pos + sf::Vector2f(border, border), color[0]));
+        vertices.append(sf::Vertex(pos + sf::Vector2f(size.x, 0), color[0]));
+
+        vertices.append(sf::Vertex(pos + sf::Vector2f(border, border), color[0]));
+        vertices.append(sf::Vertex(pos + sf::Vector2f(size.x, 0), color[0]));
+        vertices.append(sf::Vertex(pos + sf::Vector2f(size.x - border, border), color[0]));
+
+        // 左边框
+        vertices.append(sf::Vertex(pos + sf::Vector2f(0, 0), color[0]));
+        vertices.append(sf::Vertex(pos + sf::Vector2f(0, size.y), color[0]));
+        vertices.append(sf::Vertex(pos + sf::Vector2f(border, border), color[0]));
+
+        vertices.append(sf::Vertex(pos + sf::Vector2f(0, size.y), color[0]));
+        vertices.append(sf::Vertex(pos + sf::Vector2f(border, border), color[0]));
+        vertices.append(sf::Vertex(pos + sf::Vector2f(border, size.y - border), color[0]));
+
+        // 右边框
+        vertices.append(sf::Vertex(pos + sf::Vector2f(size.x, 0), color[1]));
+        vertices.append(sf::Vertex(pos + sf::Vector2f(size.x, size.y), color[1]));
+        vertices.append(sf::Vertex(pos + sf::Vector2f(size.x - border, border), color[1]));
+
+        vertices.append(sf::Vertex(pos + sf::Vector2f(size.x, size.y), color[1]));
+        vertices.append(sf::Vertex(pos + sf::Vector2f(size.x - border, border), color[1]));
+        vertices.append(sf::Vertex(pos + sf::Vector2f(size.x - border, size.y - border), color[1]));
+
+        // 下边框
+        vertices.append(sf::Vertex(pos + sf::Vector2f(0, size.y), color[1]));
+        vertices.append(sf::Vertex(pos + sf::Vector2f(border, size.y - border), color[1]));
+        vertices.append(sf::Vertex(pos + sf::Vector2f(size.x, size.y), color[1]));
+
+        vertices.append(sf::Vertex(pos + sf::Vector2f(border, size.y - border), color[1]));
+        vertices.append(sf::Vertex(pos + sf::Vector2f(size.x, size.y), color[1]));
+        vertices.append(sf::Vertex(pos + sf::Vector2f(size.x - border, size.y - border), color[1]));
+    }
+
+    // 叠加层的半透明色块，value 为是雷的概率，从绿色（安全）过渡到红色（雷）
+    static void append_overlay_vertices(sf::VertexArray& vertices, sf::Vector2f pos, sf::Vector2f size, float border, float value) {
+        const sf::Color color(static_cast<int>(255 * value), static_cast<int>(255 * (1 - value)), 0, 110);
+        const sf::Vector2f a = pos + sf::Vector2f(border, border);
+        const sf::Vector2f b = pos + size - sf::Vector2f(border, border);
+        vertices.append(sf::Vertex(a, color));
+        vertices.append(sf::Vertex(sf::Vector2f(b.x, a.y), color));
+        vertices.append(sf::Vertex(b, color));
+        vertices.append(sf::Vertex(a, color));
+        vertices.append(sf::Vertex(b, color));
+        vertices.append(sf::Vertex(sf::Vector2f(a.x, b.y), color));
+    }
+
+    Cells::Cells(int w, int h, int count)
+        : width(w), height(h), count(count), board(w, h, count), pool(w, h, count)
+    {
+        // 在后台等待，超时不会卡住画面，但也不宜让玩家等太久
+        no_guess_options.timeout = std::chrono::milliseconds(500);
+    }
+
+    void Cells::leftClick(int x, int y) {
+        if (!board.isGenerated() && !board.isFlagged(x, y)) {
+            if (isGenerating()) {
+                // 已有首次点击在等待后台布雷
+                return;
+            }
+            if (no_guess) {
+                NoGuessOptions options = no_guess_options;
+                no_guess_stop = std::stop_source();
+                options.stop = no_guess_stop.get_token();
+                pending_x = x;
+                pending_y = y;
+                no_guess_job = std::async(std::launch::async, [w = width, h = height, n = count, x, y, options] {
+                    return make_no_guess_board(w, h, n, x, y, options);
+                });
+                return;
+            }
+            started = std::chrono::steady_clock::now();
+            if (auto layout = pool.take()) {
+                dispatch(board.leftClick(x, y, std::move(*layout)));
+                return;
+            }
+        }
+        dispatch(board.leftClick(x, y));
+    }
+
+    void Cells::update() {
+        std::erase_if(no_guess_abandoned, [](const auto& job) {
+            return job.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        });
+        if (!isGenerating() || no_guess_job.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return;
+        }
+        std::optional<Board> layout = no_guess_job.get();
+        // 等待期间在这一格插了旗，放弃这次点击
+        if (board.isGenerated() || board.isFlagged(pending_x, pending_y)) {
+            return;
+        }
+        if (!layout) {
+            layout = pool.take();
+        }
+        started = std::chrono::steady_clock::now();
+        if (layout) {
+            dispatch(board.leftClick(pending_x, pending_y, std::move(*layout)));
+        } else {
+            dispatch(board.leftClick(pending_x, pending_y));
+        }
+    }
+
+    void Cells::cancelNoGuess() {
+        if (isGenerating()) {
+            // 请求停止后工作线程在当前候选内返回，大棋盘上仍要几十毫秒，留到它结束后再丢弃
+            no_guess_stop.request_stop();
+            no_guess_abandoned.push_back(std::move(no_guess_job));
+        }
+    }
+
+    void Cells::reveal(int x, int y) {
+        dispatch(board.reveal(x, y));
+    }
+
+    void Cells::dispatch(BoardResult result) {
+        version += 1;
+        journal.record(board.getChanges());
+        if (!board.isRevealing()) {
+            journal.commit();
+        }
+        if (result != BoardResult::None) {
+            // 对局结束就开始准备下一局
+            pool.refill();
+        }
+        if (result == BoardResult::Win || result == BoardResult::Lose) {
+            const BoardDifficulty difficulty = analyser.analyse(board);
+            GameSummary summary;
+            summary.bbbv = difficulty.bbbv;
+            summary.solved_bbbv = difficulty.solved_bbbv;
+            summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+            if (result == BoardResult::Win) {
+                Singleton::MessageBus::getInstance().broadcast<Message::GameWin>(
+                    std::make_shared<Message::GameWin>(summary)
+                );
+            } else {
+                Singleton::MessageBus::getInstance().broadcast<Message::GameOver>(
+                    std::make_shared<Message::GameOver>(summary)
+                );
+            }
+        }
+    }
+
+    int Cell::getMineCount() const {
+        return parent.board.getMineCount(x, y);
+    }
+
+    bool Cell::isMine() const {
+        return parent.board.isMine(x, y);
+    }
+
+    Cell::CellState Cell::getState() const {
+        return parent.board.getState(x, y);
+    }
+
+    void Cell::OnClicked(std::shared_ptr<const Base::MessageBase> message) {
+        const auto event_code = message->getTypeIndex();
+        if (event_code == typeid(Message::ClickEvent)) {
+            auto event = std::static_pointer_cast<const Message::ClickEvent>(message);
+            if (event->key == sf::Mouse::Button::Left) {
+                parent.leftClick(x, y);
+            } else if (event->key == sf::Mouse::Button::Right) {
+                parent.dispatch(parent.board.rightClick(x, y));
+            }
+        }
+    }
+
+    CellCoord::CellCoord(int w, int h, const sf::Rect<int>& rect, int count)
+        : m_cells(w, h, count), m_rect(std::make_shared<const sf::Rect<int>>(rect)),
         border(2),
         m_sprite_mine(Singleton::ResourceManager::getInstance().getMineTexture()),
         m_sprite_flag(Singleton::ResourceManager::getInstance().getFlagTexture()),
-        m_mine_count_text(Singleton::ResourceManager::getInstance().getFont(), L"0", 25),
-        x(x), y(y),
-        parent(parent)
+        m_vertices(sf::PrimitiveType::Triangles),
+        m_overlay_vertices(sf::PrimitiveType::Triangles)
     {
-        setPosition(sf::Vector2f(m_rect->position));
+        if (w <= 0 || h <= 0) {
+            throw std::invalid_argument("Invalid dimensions");
+        }
+        if (rect.size.x <= 0 || rect.size.y <= 0) {
+            throw std::invalid_argument("Invalid rectangle size");
+        }
+        m_cell_size = {rect.size.x / w, rect.size.y / h};
+        // 超过 64K 格的开口分帧翻开，避免卡住一帧
+        m_cells.board.setStreamThreshold(1 << 16);
+
+        int cell_width = m_cell_size.x;
+        int cell_height = m_cell_size.y;
 
         m_sprite_flag.setOrigin({m_sprite_flag.getTextureRect().size.x / 2.0f, m_sprite_flag.getTextureRect().size.y / 2.0f});
         m_sprite_mine.setOrigin({m_sprite_mine.getTextureRect().size.x / 2.0f, m_sprite_mine.getTextureRect().size.y / 2.0f});
-
-        m_sprite_mine.setPosition(sf::Vector2f(m_rect->size / 2));
-        m_sprite_flag.setPosition(sf::Vector2f(m_rect->size / 2));
-        
-        // 设置数字
-        {
-            m_mine_count_text.setPosition(sf::Vector2f(m_rect->size / 2));
-        }
-
-        int cell_width = rect.size.x;
-        int cell_height = rect.size.y;
         m_sprite_mine.setScale({
             static_cast<float>(cell_width - 2*border) / (m_sprite_mine.getTextureRect().size.x * 0.55f), 
             static_cast<float>(cell_height - 2*border) / (m_sprite_mine.getTextureRect().size.y * 0.55f)
@@ -138,197 +251,417 @@ namespace Game {
             static_cast<float>(cell_height - 2*border) / m_sprite_flag.getTextureRect().size.y
         });
 
-        // 顶点
-        {    
-            auto size = m_rect->size;
-            // 顶点布局：
-            // 0---1---2
-            // |  / |  / |
-            // | /  | /  |
-            // 3---4---5
-
-            vertices.append(sf::Vertex(sf::Vector2f(0, 0), BColor[0][2]));        // 0
-            vertices.append(sf::Vertex(sf::Vector2f(size.x, 0), BColor[0][2]));   // 1
-            vertices.append(sf::Vertex(sf::Vector2f(size.x, size.y), BColor[0][2])); // 2
-            vertices.append(sf::Vertex(sf::Vector2f(0, 0), BColor[0][2]));        // 3
-            vertices.append(sf::Vertex(sf::Vector2f(size.x, size.y), BColor[0][2])); // 4
-            vertices.append(sf::Vertex(sf::Vector2f(0, size.y), BColor[0][2]));  // 5
-
-            // 上边框（使用三角形带）
-            // 三角形1: (0,0)-(border,border)-(size.x,0)
-            // 三角形2: (border,border)-(size.x,0)-(size.x-border,border)
-            vertices.append(sf::Vertex(sf::Vector2f(0, 0), BColor[0][0]));
-            vertices.append(sf::Vertex(sf::Vector2f(border, border), BColor[0][0]));
-            vertices.append(sf::Vertex(sf::Vector2f(size.x, 0), BColor[0][0]));
-            
-            vertices.append(sf::Vertex(sf::Vector2f(border, border), BColor[0][0]));
-            vertices.append(sf::Vertex(sf::Vector2f(size.x, 0), BColor[0][0]));
-            vertices.append(sf::Vertex(sf::Vector2f(size.x - border, border), BColor[0][0]));
-            
-            // 左边框
-            vertices.append(sf::Vertex(sf::Vector2f(0, 0), BColor[0][0]));
-            vertices.append(sf::Vertex(sf::Vector2f(0, size.y), BColor[0][0]));
-            vertices.append(sf::Vertex(sf::Vector2f(border, border), BColor[0][0]));
-            
-            vertices.append(sf::Vertex(sf::Vector2f(0, size.y), BColor[0][0]));
-            vertices.append(sf::Vertex(sf::Vector2f(border, border), BColor[0][0]));
-            vertices.append(sf::Vertex(sf::Vector2f(border, size.y - border), BColor[0][0]));
-
-            // 右边框
-            vertices.append(sf::Vertex(sf::Vector2f(size.x, 0), BColor[0][1]));
-            vertices.append(sf::Vertex(sf::Vector2f(size.x, size.y), BColor[0][1]));
-            vertices.append(sf::Vertex(sf::Vector2f(size.x - border, border), BColor[0][1]));
-            
-            vertices.append(sf::Vertex(sf::Vector2f(size.x, size.y), BColor[0][1]));
-            vertices.append(sf::Vertex(sf::Vector2f(size.x - border, border), BColor[0][1]));
-            vertices.append(sf::Vertex(sf::Vector2f(size.x - border, size.y - border), BColor[0][1]));
-
-            // 下边框
-            vertices.append(sf::Vertex(sf::Vector2f(0, size.y), BColor[0][1]));
-            vertices.append(sf::Vertex(sf::Vector2f(border, size.y - border), BColor[0][1]));
-            vertices.append(sf::Vertex(sf::Vector2f(size.x, size.y), BColor[0][1]));
-            
-            vertices.append(sf::Vertex(sf::Vector2f(border, size.y - border), BColor[0][1]));
-            vertices.append(sf::Vertex(sf::Vector2f(size.x, size.y), BColor[0][1]));
-            vertices.append(sf::Vertex(sf::Vector2f(size.x - border, size.y - border), BColor[0][1]));
+        // 设置数字，下标即为周围雷数
+        m_mine_count_texts.reserve(Topology::Cube26::DEGREE + 1);
+        for (int i = 0; i <= Topology::Cube26::DEGREE; ++i) {
+            auto& text = m_mine_count_texts.emplace_back(Singleton::ResourceManager::getInstance().getFont(), std::to_string(i), 25);
+            const auto _bounds = text.getLocalBounds();
+            text.setOrigin(_bounds.getCenter());
+            float scale_x = (cell_width - 2 * border) * 0.5f / _bounds.size.x;
+            text.setScale({scale_x, scale_x});
         }
     }
 
-    void Cell::update(CellState state) {
-        if (state == this->state){
+    void CellCoord::OnClicked(std::shared_ptr<const Base::MessageBase> message) {
+        if (m_world) {
+            onWorldClicked(message);
+            return;
+        }
+        if (getVariant() != BoardVariant::Classic) {
+            onGridClicked(message);
             return;
-        } else {
-            this->state = state;
         }
-        if (state == CellState::Empty) {
-            int i;
-            for (i = 0; i < 6; ++i) {
-                vertices[i].color = BColor[0][2];
+        const auto event_code = message->getTypeIndex();
+        if (event_code == typeid(Message::ClickEvent)) {
+            auto event = std::static_pointer_cast<const Message::ClickEvent>(message);
+            auto local = event->position - m_rect->position;
+            int x = local.x / m_cell_size.x;
+            int y = local.y / m_cell_size.y;
+            if (local.x >= 0 && local.y >= 0 && m_cells.board.contains(x, y)) {
+                m_cells(x, y).OnClicked(message);
             }
-
-            // 上边框
-            for (i = 6; i < 18; ++i) {
-                vertices[i].color = BColor[0][0];
+        } else if (event_code == typeid(Message::DClickEvent)) {
+            auto event = std::static_pointer_cast<const Message::DClickEvent>(message);
+            auto local = event->position - m_rect->position;
+            int x = local.x / m_cell_size.x;
+            int y = local.y / m_cell_size.y;
+            if (event->key == sf::Mouse::Button::Left && local.x >= 0 && local.y >= 0 && m_cells.board.contains(x, y)) {
+                m_cells.chord(x, y);
             }
+        }
+    }
 
-            // 下边框
-            for (i = 18; i < 30; ++i) {
-                vertices[i].color = BColor[0][1];
+    void CellCoord::update(sf::Time budget) {
+        if (m_world) {
+            // ChunkWorld 按格数分段，这里按时间预算循环
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(budget.asMicroseconds());
+            while (m_world->isRevealing() && std::chrono::steady_clock::now() < deadline) {
+                m_world->revealStep(4096);
             }
+            m_world->visit(m_camera_x, m_camera_y, m_camera_x + m_cells.width - 1, m_camera_y + m_cells.height - 1);
+            return;
         }
-        if (state == CellState::Uncovered) {
-            int i;
-            // 面
-            for (i = 0; i < 6; ++i) {
-                vertices[i].color = BColor[1][2];
-            }
+        // GridBoard 在点击时一次翻开完毕
+        if (getVariant() != BoardVariant::Classic) {
+            return;
+        }
+        m_cells.update();
+        if (m_cells.board.isRevealing()) {
+            m_cells.dispatch(m_cells.board.revealStep(std::chrono::microseconds(budget.asMicroseconds())));
+        }
+        // 分帧翻开的中间状态很快就会过期，翻开结束后再提交
+        if (m_overlay != OverlayMode::None && !m_cells.board.isRevealing()
+            && (m_overlay_stale || m_analysed_version != m_cells.version)) {
+            m_analysis.submit(m_cells.board, m_overlay, m_cells.version);
+            m_analysed_version = m_cells.version;
+            m_overlay_stale = false;
+        }
+    }
 
-            // 上边框
-            for (i = 6; i < 18; ++i) {
-                vertices[i].color = BColor[1][0];
-            }
+    void CellCoord::reset() {
+        if (m_world) {
+            newWorld();
+        }
+        if (getVariant() != BoardVariant::Classic) {
+            newGrid(getVariant());
+        }
+        m_cells.reset();
+    }
 
-            // 下边框
-            for (i = 18; i < 30; ++i) {
-                vertices[i].color = BColor[1][1];
-            }
-            if (!m_is_mine) parent.uncovered -= 1;
-            if (parent.uncovered == 0) {
-                Singleton::MessageBus::getInstance().broadcast<Message::GameWin>(
-                    std::make_shared<Message::GameWin>()
-                );
+    void CellCoord::setEndless(bool enabled) {
+        if (enabled == isEndless()) {
+            return;
+        }
+        if (enabled) {
+            setOverlay(OverlayMode::None);
+            m_grid.emplace<std::monostate>();
+            newWorld();
+        } else {
+            m_world.reset();
+        }
+        m_cells.reset();
+    }
+
+    void CellCoord::newWorld() {
+        const double density = static_cast<double>(m_cells.count) / (m_cells.width * m_cells.height);
+        std::random_device device;
+        m_world = std::make_unique<ChunkWorld>((uint64_t(device()) << 32) ^ device(), density);
+        // 与有限棋盘一致，大的开口分帧翻开
+        m_world->setRevealLimit(1 << 16);
+        m_camera_x = m_camera_y = 0;
+        m_world_lost = false;
+    }
+
+    void CellCoord::pan(int dx, int dy) {
+        m_camera_x += dx;
+        m_camera_y += dy;
+    }
+
+    void CellCoord::onWorldClicked(std::shared_ptr<const Base::MessageBase> message) {
+        if (m_world_lost || message->getTypeIndex() != typeid(Message::ClickEvent)) {
+            return;
+        }
+        auto event = std::static_pointer_cast<const Message::ClickEvent>(message);
+        auto local = event->position - m_rect->position;
+        int x = local.x / m_cell_size.x;
+        int y = local.y / m_cell_size.y;
+        if (local.x < 0 || local.y < 0 || x >= m_cells.width || y >= m_cells.height) {
+            return;
+        }
+        if (event->key == sf::Mouse::Button::Left) {
+            if (!m_world->isStarted()) {
+                m_world_started = std::chrono::steady_clock::now();
             }
-        } else if (state == CellState::Flag) {
-            if (m_is_mine) parent.flag_mine_count++;
-            if (parent.flag_mine_count == parent.count) {
-                Singleton::MessageBus::getInstance().broadcast<Message::GameWin>(
-                    std::make_shared<Message::GameWin>()
+            if (m_world->leftClick(m_camera_x + x, m_camera_y + y) == BoardResult::Lose) {
+                m_world_lost = true;
+                // 无尽模式没有 3BV，只记录用时
+                GameSummary summary;
+                summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_world_started).count();
+                Singleton::MessageBus::getInstance().broadcast<Message::GameOver>(
+                    std::make_shared<Message::GameOver>(summary)
                 );
             }
+        } else if (event->key == sf::Mouse::Button::Right) {
+            m_world->rightClick(m_camera_x + x, m_camera_y + y);
         }
     }
 
-    void Cell::OnClicked(std::shared_ptr<const Base::MessageBase> message) {
+    sf::Vector2i CellCoord::cellAt(sf::Vector2i position) const {
+        const auto local = position - m_rect->position;
+        if (getVariant() != BoardVariant::Hex) {
+            return {local.x / m_cell_size.x, local.y / m_cell_size.y};
+        }
+        const sf::Vector2f size = gridCellSize();
+        const int y = local.y / m_cell_size.y;
+        const float shift = (y & 1) ? size.x / 2.0f : 0.0f;
+        return {static_cast<int>(std::floor((local.x - shift) / size.x)), y};
+    }
+
+    sf::Vector2f CellCoord::gridCellSize() const {
+        if (getVariant() == BoardVariant::Hex) {
+            return {m_rect->size.x * 2.0f / (2 * m_cells.width + 1), static_cast<float>(m_cell_size.y)};
+        }
+        return sf::Vector2f(m_cell_size);
+    }
+
+    void CellCoord::setVariant(BoardVariant variant) {
+        if (variant == getVariant()) {
+            return;
+        }
+        if (variant != BoardVariant::Classic) {
+            setOverlay(OverlayMode::None);
+            m_world.reset();
+        }
+        newGrid(variant);
+        m_cells.reset();
+    }
+
+    void CellCoord::cycleVariant() {
+        switch (getVariant()) {
+            case BoardVariant::Classic: setVariant(BoardVariant::Hex); break;
+            case BoardVariant::Hex: setVariant(BoardVariant::Torus); break;
+            case BoardVariant::Torus: setVariant(BoardVariant::Cube); break;
+            case BoardVariant::Cube: setVariant(BoardVariant::Classic); break;
+        }
+    }
+
+    void CellCoord::stepLayer(int dz) {
+        if (getVariant() == BoardVariant::Cube) {
+            m_layer = std::clamp(m_layer + dz, 0, CUBE_DEPTH - 1);
+        }
+    }
+
+    void CellCoord::newGrid(BoardVariant variant) {
+        const int w = m_cells.width, h = m_cells.height, count = m_cells.count;
+        switch (variant) {
+            case BoardVariant::Classic: m_grid.emplace<std::monostate>(); break;
+            case BoardVariant::Hex: m_grid.emplace<HexBoard>(w, h, 1, count); break;
+            case BoardVariant::Torus: m_grid.emplace<TorusBoard>(w, h, 1, count); break;
+            // 每层的密度与经典棋盘相同
+            case BoardVariant::Cube: m_grid.emplace<CubeBoard>(w, h, CUBE_DEPTH, count * CUBE_DEPTH); break;
+        }
+        m_layer = 0;
+        m_grid_over = false;
+    }
+
+    void CellCoord::onGridClicked(std::shared_ptr<const Base::MessageBase> message) {
         const auto event_code = message->getTypeIndex();
-        if (event_code == typeid(Message::ClickEvent)) {
+        if (m_grid_over || (event_code != typeid(Message::ClickEvent) && event_code != typeid(Message::DClickEvent))) {
+            return;
+        }
+        const bool chord = event_code == typeid(Message::DClickEvent);
+        sf::Vector2i position;
+        sf::Mouse::Button key;
+        if (chord) {
+            auto event = std::static_pointer_cast<const Message::DClickEvent>(message);
+            position = event->position;
+            key = event->key;
+        } else {
             auto event = std::static_pointer_cast<const Message::ClickEvent>(message);
-            if (event->key == sf::Mouse::Button::Left) {
-                if (state == CellState::Empty) {
-                    yeild_mines(parent, parent.width, parent.height, parent.count, x, y);
-                    for (auto& cell : parent._cells) {
-                        if (cell.state == CellState::Empty) {
-                            cell.update(CellState::Default);
-                            cell.updateMineText();
-                        }
-                    }
-                    parent.reveal(x, y);
-                } else if (m_is_mine) {
-                    update(CellState::Uncovered);
-                    Singleton::MessageBus::getInstance().broadcast<Message::GameOver>(
-                        std::make_shared<Message::GameOver>()
-                    );
-                } else if (m_mine_count > 0) {
-                    update(CellState::Uncovered);
-                } else {
-                    parent.reveal(x, y);
+            position = event->position;
+            key = event->key;
+        }
+        const sf::Vector2i cell = cellAt(position);
+        const BoardResult result = std::visit([&](auto& grid) {
+            if constexpr (std::is_same_v<std::decay_t<decltype(grid)>, std::monostate>) {
+                return BoardResult::None;
+            } else {
+                if (!grid.contains(cell.x, cell.y, m_layer)) {
+                    return BoardResult::None;
                 }
-            } else if (event->key == sf::Mouse::Button::Right) {
-                if (state == CellState::Default || state == CellState::Empty) {
-                    update(CellState::Flag);
-                } else if (state == CellState::Flag) {
-                    update(CellState::Default);
+                if (chord) {
+                    return key == sf::Mouse::Button::Left ? grid.chord(cell.x, cell.y, m_layer) : BoardResult::None;
+                }
+                if (key == sf::Mouse::Button::Right) {
+                    return grid.rightClick(cell.x, cell.y, m_layer);
+                }
+                if (!grid.isGenerated()) {
+                    m_grid_started = std::chrono::steady_clock::now();
                 }
+                return key == sf::Mouse::Button::Left ? grid.leftClick(cell.x, cell.y, m_layer) : BoardResult::None;
             }
+        }, m_grid);
+        if (result != BoardResult::Win && result != BoardResult::Lose) {
+            return;
+        }
+        m_grid_over = true;
+        // 变体没有 3BV，只记录用时
+        GameSummary summary;
+        summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_grid_started).count();
+        if (result == BoardResult::Win) {
+            Singleton::MessageBus::getInstance().broadcast<Message::GameWin>(
+                std::make_shared<Message::GameWin>(summary)
+            );
+        } else {
+            Singleton::MessageBus::getInstance().broadcast<Message::GameOver>(
+                std::make_shared<Message::GameOver>(summary)
+            );
         }
     }
 
-    Base::Control::BoundsPtr Cell::getBounds() const {
-        return m_rect;
+    void CellCoord::setOverlay(OverlayMode mode) {
+        if (mode == m_overlay) {
+            return;
+        }
+        m_overlay = mode;
+        m_overlay_stale = true;
+        if (mode == OverlayMode::None) {
+            m_analysis.cancel();
+        }
     }
 
-    void Cell::updateMineText() {
-        m_mine_count_text.setString(std::to_string(m_mine_count));
-        const auto _bounds = m_mine_count_text.getLocalBounds();
-        m_mine_count_text.setOrigin(_bounds.getCenter());
-        float scale_x = (m_rect->size.x - 2 * border) * 0.5f / _bounds.size.x;
-        m_mine_count_text.setScale({scale_x, scale_x});
+    void CellCoord::cycleOverlay() {
+        switch (m_overlay) {
+            case OverlayMode::None: setOverlay(OverlayMode::Markers); break;
+            case OverlayMode::Markers: setOverlay(OverlayMode::Probabilities); break;
+            case OverlayMode::Probabilities: setOverlay(OverlayMode::None); break;
+        }
     }
 
-    IDCode Cell::getCode() const {
-        return m_id.getCode();
-    }
+    void CellCoord::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+        const auto& board = m_cells.board;
+        const auto& view = target.getView();
+        const sf::Vector2f view_min = view.getCenter() - view.getSize() / 2.0f;
+        const sf::Vector2f view_max = view.getCenter() + view.getSize() / 2.0f;
+        const sf::Vector2f origin(m_rect->position);
+        const sf::Vector2f size(m_cell_size);
+
+        int x0 = std::max(0, static_cast<int>((view_min.x - origin.x) / size.x));
+        int y0 = std::max(0, static_cast<int>((view_min.y - origin.y) / size.y));
+        int x1 = std::min(board.getWidth() - 1, static_cast<int>((view_max.x - origin.x) / size.x));
+        int y1 = std::min(board.getHeight() - 1, static_cast<int>((view_max.y - origin.y) / size.y));
+        if (x0 > x1 || y0 > y1) {
+            return;
+        }
+        if (m_world) {
+            drawWorld(target, states, x0, y0, x1, y1);
+            return;
+        }
+        if (getVariant() != BoardVariant::Classic) {
+            drawGrid(target, states, y0, y1);
+            return;
+        }
 
-    void Cell::draw(sf::RenderTarget& target, sf::RenderStates states) const {
-        states.transform *= getTransform();
-        target.draw(vertices, states);
-        if (state == CellState::Flag) {
-            target.draw(m_sprite_flag, states);
-        } else if (state == CellState::Uncovered) {
-            if (m_is_mine) {
-                target.draw(m_sprite_mine, states);
-            } else if (m_mine_count > 0) {
-                target.draw(m_mine_count_text, states);
+        m_vertices.clear();
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                sf::Vector2f pos = origin + sf::Vector2f(x * size.x, y * size.y);
+                append_cell_vertices(m_vertices, pos, size, static_cast<float>(border), board.isRevealed(x, y) ? 1 : 0);
             }
         }
-    }
+        target.draw(m_vertices, states);
 
-    CellCoord::CellCoord(int w, int h, const sf::Rect<int>& rect, int count)
-        : m_cells(w, h, rect, count), m_rect(std::make_shared<const sf::Rect<int>>(rect))
-    {
-        if (w <= 0 || h <= 0) {
-            throw std::invalid_argument("Invalid dimensions");
+        if (m_overlay != OverlayMode::None) {
+            m_overlay_vertices.clear();
+            m_analysis.read([&](const AnalysisResult& result) {
+                // 模式或尺寸不符的是切换前或上一局的结果
+                if (result.mode != m_overlay || result.width != board.getWidth() || result.height != board.getHeight()) {
+                    return;
+                }
+                for (int y = y0; y <= y1; ++y) {
+                    for (int x = x0; x <= x1; ++x) {
+                        const float value = result.values[y * result.width + x];
+                        if (value >= 0 && !board.isRevealed(x, y) && !board.isFlagged(x, y)) {
+                            append_overlay_vertices(m_overlay_vertices, origin + sf::Vector2f(x * size.x, y * size.y), size, static_cast<float>(border), value);
+                        }
+                    }
+                }
+            });
+            target.draw(m_overlay_vertices, states);
         }
-        if (rect.size.x <= 0 || rect.size.y <= 0) {
-            throw std::invalid_argument("Invalid rectangle size");
+
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                sf::RenderStates cell_states = states;
+                cell_states.transform.translate(origin + sf::Vector2f(x * size.x, y * size.y) + size / 2.0f);
+                if (board.isFlagged(x, y)) {
+                    target.draw(m_sprite_flag, cell_states);
+                } else if (board.isRevealed(x, y)) {
+                    if (board.isMine(x, y)) {
+                        target.draw(m_sprite_mine, cell_states);
+                    } else if (board.getMineCount(x, y) > 0) {
+                        target.draw(m_mine_count_texts[board.getMineCount(x, y)], cell_states);
+                    }
+                }
+            }
         }
     }
 
-    void CellCoord::draw(sf::RenderTarget& target, sf::RenderStates states) const {
-        for(const auto& cell : m_cells._cells) {
-            target.draw(cell, states);
+    void CellCoord::drawWorld(sf::RenderTarget& target, sf::RenderStates states, int x0, int y0, int x1, int y1) const {
+        const sf::Vector2f origin(m_rect->position);
+        const sf::Vector2f size(m_cell_size);
+        // 可见区块已由 update 中的 visit 加载，这里只读；尚未加载的按未翻开绘制
+        auto state_at = [&](int x, int y, int& mines) {
+            CellState state = CellState::Default;
+            mines = 0;
+            m_world->peek(m_camera_x + x, m_camera_y + y, state, mines);
+            return state;
+        };
+
+        m_vertices.clear();
+        int mines = 0;
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                sf::Vector2f pos = origin + sf::Vector2f(x * size.x, y * size.y);
+                append_cell_vertices(m_vertices, pos, size, static_cast<float>(border), state_at(x, y, mines) == CellState::Uncovered ? 1 : 0);
+            }
+        }
+        target.draw(m_vertices, states);
+
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                sf::RenderStates cell_states = states;
+                cell_states.transform.translate(origin + sf::Vector2f(x * size.x, y * size.y) + size / 2.0f);
+                const CellState state = state_at(x, y, mines);
+                if (state == CellState::Flag) {
+                    target.draw(m_sprite_flag, cell_states);
+                } else if (state == CellState::Uncovered) {
+                    if (m_world->isMine(m_camera_x + x, m_camera_y + y)) {
+                        target.draw(m_sprite_mine, cell_states);
+                    } else if (mines > 0) {
+                        target.draw(m_mine_count_texts[mines], cell_states);
+                    }
+                }
+            }
         }
     }
 
+    void CellCoord::drawGrid(sf::RenderTarget& target, sf::RenderStates states, int y0, int y1) const {
+        const sf::Vector2f origin(m_rect->position);
+        const sf::Vector2f size = gridCellSize();
+        std::visit([&](const auto& grid) {
+            if constexpr (!std::is_same_v<std::decay_t<decltype(grid)>, std::monostate>) {
+                constexpr bool hex = std::is_same_v<std::decay_t<decltype(grid)>, HexBoard>;
+                auto position = [&](int x, int y) {
+                    return origin + sf::Vector2f(x * size.x + (hex && (y & 1) ? size.x / 2.0f : 0.0f), y * size.y);
+                };
+                m_vertices.clear();
+                for (int y = y0; y <= y1; ++y) {
+                    for (int x = 0; x < grid.getWidth(); ++x) {
+                        append_cell_vertices(m_vertices, position(x, y), size, static_cast<float>(border), grid.isRevealed(x, y, m_layer) ? 1 : 0);
+                    }
+                }
+                target.draw(m_vertices, states);
+
+                for (int y = y0; y <= y1; ++y) {
+                    for (int x = 0; x < grid.getWidth(); ++x) {
+                        sf::RenderStates cell_states = states;
+                        cell_states.transform.translate(position(x, y) + size / 2.0f);
+                        if (grid.isFlagged(x, y, m_layer)) {
+                            target.draw(m_sprite_flag, cell_states);
+                        } else if (grid.isRevealed(x, y, m_layer)) {
+                            if (grid.isMine(x, y, m_layer)) {
+                                target.draw(m_sprite_mine, cell_states);
+                            } else if (grid.getMineCount(x, y, m_layer) > 0) {
+                                target.draw(m_mine_count_texts[grid.getMineCount(x, y, m_layer)], cell_states);
+                            }
+                        }
+                    }
+                }
+            }
+        }, m_grid);
+    }
+
     GameButton::GameButton(const sf::Rect<int>& rect, const std::string& text)
         : m_rect(std::make_shared<const sf::Rect<int>>(rect)),
         m_text(Singleton::ResourceManager::getInstance().getFont(), text, 25),
@@ -538,42 +871,3 @@ namespace Game {
         target.draw(state_sprite, states);
     }
 }
-
-static void yeild_mines(Game::Cells& cells, int w, int h, int count, int px, int py) {
-    if (count == 0) {
-        throw std::invalid_argument("Invalid mine count");
-    } else if(w*h - 9 < count) {
-        throw std::invalid_argument("Too many mines");
-    } else {
-        auto map = std::vector<int>();
-        map.reserve(w * h - 9);
-        for(int y=0; y<h; ++y) {
-            for(int x=0; x<w; ++x) {
-                if ((x >= px -1 && x <= px+1) && (y >= py-1 && y <= py+1)) {
-                    continue;
-                } else {
-                    map.push_back(y*w + x);
-                }
-            }
-        }
-
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        
-        std::shuffle(map.begin(), map.end(), gen);
-
-        for (int i = 0; i < count; ++i) {
-            cells._cells[map[i]].setMine(true);
-            int x = map[i] % w;
-            int y = map[i] / w;
-            if (x - 1 >= 0 && y - 1 >= 0) cells._cells[(y-1)*w + x-1].addMineCount();
-            if (x - 1 >= 0 && y + 1 < h) cells._cells[(y+1)*w + x-1].addMineCount();
-            if (x + 1 < w && y - 1 >= 0) cells._cells[(y-1)*w + x + 1].addMineCount();
-            if (x + 1 < w && y + 1 < h) cells._cells[(y+1)*w + x + 1].addMineCount();
-            if (x - 1 >= 0) cells._cells[y*w + x-1].addMineCount();
-            if (x + 1 < w) cells._cells[y*w + x+1].addMineCount();
-            if (y - 1 >= 0) cells._cells[(y-1)*w + x].addMineCount();
-            if (y + 1 < h) cells._cells[(y+1)*w + x].addMineCount();
-        }
-    }
-}
\ No newline at end of file
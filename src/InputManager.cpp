@@ -25,6 +25,7 @@ namespace Singleton {
         }
         
         std::sort(control_ids->second.begin(), control_ids->second.end());
+        targets[control.getCode()] = &control;
         if (root == nullptr) {
             root = std::make_unique<QuadTree::QuadTreeNode>(control.getBounds());
         }
@@ -40,6 +41,7 @@ namespace Singleton {
             }
         }
 
+        targets.erase(id);
         root->remove(id);
     }
 
@@ -50,6 +52,11 @@ namespace Singleton {
         }
     }
 
+    auto InputManager::isSameTarget(const IDCode id, sf::Vector2i a, sf::Vector2i b) const -> bool {
+        auto it = targets.find(id);
+        return it == targets.end() || it->second->getClickTarget(a) == it->second->getClickTarget(b);
+    }
+
     struct MoueClickInfo {
         IDCode id;
         sf::Vector2i position;
@@ -69,6 +76,28 @@ namespace Singleton {
             {
                 using MouseClinckInfoTable = std::array<std::optional<MoueClickInfo>, sf::Mouse::ButtonCount>;
                 static MouseClinckInfoTable mouse_click_time_table = {};
+
+                // 发出等待中的单击并清空记录
+                auto send_click = [&](std::optional<MoueClickInfo>& info, unsigned int button) {
+                    IDCode id = info->id;
+                    sf::Vector2i position = info->position;
+                    info = std::nullopt;
+                    auto& control_ids = controls[typeid(Message::ClickEvent)];
+                    auto it = std::lower_bound(control_ids.begin(), control_ids.end(), id);
+                    if (it != control_ids.end() && *it == id) {
+                        std::future<void> future = std::async(std::launch::async, [id, position, button]() {
+                            MessageBus::getInstance().send(
+                                id, 
+                                std::make_shared<Message::ClickEvent>(
+                                    position,
+                                    static_cast<sf::Mouse::Button>(button)
+                                )
+                            );
+                        });
+
+                        futures.push_back(std::move(future));
+                    }
+                };
                 
                 for (unsigned int i =0; i < sf::Mouse::ButtonCount; ++i) {
                     auto& info = mouse_click_time_table.at(i);
@@ -76,24 +105,7 @@ namespace Singleton {
                         // 单击
                         if (info->count == 1) {
                             if (info->timer->getElapsedTime() > TIME_OUT) {
-                                IDCode id = info->id;
-                                sf::Vector2i position = info->position;
-                                info = std::nullopt;
-                                auto& control_ids = controls[typeid(Message::ClickEvent)];
-                                auto it = std::lower_bound(control_ids.begin(), control_ids.end(), id);
-                                if (it != control_ids.end() && *it == id) {
-                                    std::future<void> future = std::async(std::launch::async, [id, position, i]() {
-                                        MessageBus::getInstance().send(
-                                            id, 
-                                            std::make_shared<Message::ClickEvent>(
-                                                position,
-                                                static_cast<sf::Mouse::Button>(i)
-                                            )
-                                        );
-                                    });
-
-                                    futures.push_back(std::move(future));
-                                }
+                                send_click(info, i);
                             }
                         }
                     }
@@ -155,15 +167,23 @@ namespace Singleton {
                             info->timer->restart();
                         } else {
                             auto new_id = root->query(e->position);
-                            if (!new_id.has_value()) {
-                                info = std::nullopt;
-                            } else if (new_id.value() == info->id) {
+                            if (new_id.has_value() && new_id.value() == info->id && isSameTarget(info->id, info->position, e->position)) {
                                 info->timer->restart();
                             } else {
-                                info->id = new_id.value();
-                                info->position = e->position;
-                                info->count = 0;
-                                info->timer->restart();
+                                // 落在别的控件或别的目标上：前一次单击立即发出，这次按下重新开始计数
+                                if (info->count == 1) {
+                                    send_click(info, static_cast<unsigned int>(e->button));
+                                }
+                                info = std::nullopt;
+                                if (new_id.has_value()) {
+                                    info = MoueClickInfo{
+                                        new_id.value(), 
+                                        e->position, 
+                                        std::make_unique<sf::Clock>(), 
+                                        0
+                                    };
+                                    info->timer->restart();
+                                }
                             }
                         }
                     } else {
@@ -0,0 +1,97 @@
+#include <AnalysisWorker.hpp>
+#include <utility>
+
+namespace Game {
+    AnalysisWorker::AnalysisWorker() : m_worker(&AnalysisWorker::run, this) {}
+
+    AnalysisWorker::~AnalysisWorker() {
+        {
+            std::lock_guard lock(m_mutex);
+            m_stop = true;
+            m_cancel.request_stop();
+        }
+        m_wake.notify_all();
+        m_worker.join();
+    }
+
+    void AnalysisWorker::submit(const Board& board, OverlayMode mode, uint64_t version) {
+        {
+            std::lock_guard lock(m_mutex);
+            m_cancel.request_stop();
+            m_cancel = std::stop_source();
+            m_job.snapshot(board);
+            m_has_job = true;
+            m_job_mode = mode;
+            m_job_version = version;
+        }
+        m_wake.notify_one();
+    }
+
+    void AnalysisWorker::cancel() {
+        std::lock_guard lock(m_mutex);
+        m_cancel.request_stop();
+        m_has_job = false;
+    }
+
+    void AnalysisWorker::run() {
+        // 锁只在交接任务时持有，分析本身不持锁
+        std::unique_lock lock(m_mutex);
+        for (;;) {
+            m_wake.wait(lock, [this] { return m_stop || m_has_job; });
+            if (m_stop) {
+                return;
+            }
+            std::swap(m_board, m_job);
+            m_has_job = false;
+            const Board& board = m_board;
+            const OverlayMode mode = m_job_mode;
+            const uint64_t version = m_job_version;
+            const std::stop_token stop = m_cancel.get_token();
+            lock.unlock();
+
+            const int cells = board.getWidth() * board.getHeight();
+            m_values.assign(cells, -1.0f);
+            if (mode == OverlayMode::Markers) {
+                const bool settled = m_solver.solve(board, -1, stop);
+                for (int i = 0; settled && i < cells; ++i) {
+                    const auto k = m_solver.get(i % board.getWidth(), i / board.getWidth());
+                    if (!board.isRevealed(i % board.getWidth(), i / board.getWidth()) && k != Solver::Knowledge::Unknown) {
+                        m_values[i] = k == Solver::Knowledge::Mine ? 1.0f : 0.0f;
+                    }
+                }
+            } else if (mode == OverlayMode::Probabilities) {
+                m_probability.compute(board, stop);
+                if (!m_probability.isCancelled()) {
+                    for (int i = 0; i < cells; ++i) {
+                        if (!board.isRevealed(i % board.getWidth(), i / board.getWidth())) {
+                            m_values[i] = static_cast<float>(m_probability.getProbabilities()[i]);
+                        }
+                    }
+                }
+            }
+            if (!stop.stop_requested()) {
+                publish(board, mode, version);
+            }
+            lock.lock();
+        }
+    }
+
+    void AnalysisWorker::publish(const Board& board, OverlayMode mode, uint64_t version) {
+        const uint32_t back = (m_state.load(std::memory_order_relaxed) & FRONT) ^ 1;
+        // 读者只会登记前台槽位；后台槽位在上次交换前被读者取走时，等它读完（只有工作线程等待）
+        while (m_state.load(std::memory_order_acquire) & (READING << back)) {
+            std::this_thread::yield();
+        }
+        AnalysisResult& result = m_slots[back];
+        result.width = board.getWidth();
+        result.height = board.getHeight();
+        result.version = version;
+        result.mode = mode;
+        result.values.swap(m_values);
+
+        uint32_t state = m_state.load(std::memory_order_relaxed);
+        while (!m_state.compare_exchange_weak(state, (state & ~FRONT) | back, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+        m_published.store(true, std::memory_order_release);
+    }
+}
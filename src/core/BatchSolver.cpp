@@ -0,0 +1,313 @@
+#include <BatchSolver.hpp>
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+namespace Game {
+    BatchSolver::BatchSolver(int w, int h, int count)
+        : m_width(w), m_height(h), m_count(count), m_padded(w + 2)
+    {
+        if (w <= 0 || h <= 0) {
+            throw std::invalid_argument("Invalid dimensions");
+        }
+        if (count <= 0 || count > w * h - 9) {
+            throw std::invalid_argument("Invalid mine count");
+        }
+        const int p = m_padded;
+        const int offsets[8] = {-p - 1, -p, -p + 1, -1, 1, p - 1, p, p + 1};
+        std::copy(std::begin(offsets), std::end(offsets), m_neighbours);
+        m_cells.reserve(static_cast<std::size_t>(w) * h);
+        for (int y = 0; y < h; ++y) {
+            for (int x = 0; x < w; ++x) {
+                m_cells.push_back(index(x, y));
+            }
+        }
+        const std::size_t size = static_cast<std::size_t>(m_padded) * (h + 2);
+        m_mines.resize(size);
+        m_revealed.resize(size);
+        m_flags.resize(size);
+        m_zeros.resize(size);
+        m_numbers.resize(size);
+        clear();
+    }
+
+    void BatchSolver::clear() {
+        // 哨兵格对所有局都是已翻开
+        std::fill(m_revealed.begin(), m_revealed.end(), ~Lanes(0));
+        for (int c : m_cells) {
+            m_revealed[c] = 0;
+        }
+        std::fill(m_mines.begin(), m_mines.end(), 0);
+        std::fill(m_flags.begin(), m_flags.end(), 0);
+        std::fill(m_zeros.begin(), m_zeros.end(), 0);
+        std::fill(m_numbers.begin(), m_numbers.end(), Count{});
+        m_loaded = m_won = m_lost = 0;
+        m_counts_dirty = false;
+        m_flood_needed = false;
+    }
+
+    void BatchSolver::generate(int px, int py, RandomRef random) {
+        if (px < 0 || px >= m_width || py < 0 || py >= m_height) {
+            throw std::invalid_argument("First click outside the board");
+        }
+        clear();
+        // 直接按位布雷，不经过 Board：每局在安全区外反复抽取格子
+        // 雷多于可用格的一半时改为先布满再随机移走，两种情况抽取次数都不超过可用格数的常数倍
+        const int cells = static_cast<int>(m_cells.size());
+        auto safe_zone = [&](int i) {
+            const int x = i % m_width, y = i / m_width;
+            return x >= px - 1 && x <= px + 1 && y >= py - 1 && y <= py + 1;
+        };
+        int available = 0;
+        for (int i = 0; i < cells; ++i) {
+            available += !safe_zone(i);
+        }
+        const bool inverse = m_count * 2 > available;
+        const int picks = inverse ? available - m_count : m_count;
+        for (int lane = 0; lane < LANES; ++lane) {
+            const Lanes bit = Lanes(1) << lane;
+            if (inverse) {
+                for (int i = 0; i < cells; ++i) {
+                    if (!safe_zone(i)) {
+                        m_mines[m_cells[i]] |= bit;
+                    }
+                }
+            }
+            for (int placed = 0; placed < picks;) {
+                const int i = static_cast<int>(random.below(cells));
+                Lanes& mines = m_mines[m_cells[i]];
+                if (safe_zone(i) || ((mines & bit) != 0) != inverse) {
+                    continue;
+                }
+                mines ^= bit;
+                placed += 1;
+            }
+        }
+        m_loaded = ~Lanes(0);
+        m_counts_dirty = true;
+    }
+
+    void BatchSolver::load(int lane, const Board& board) {
+        if (lane < 0 || lane >= LANES || board.getWidth() != m_width || board.getHeight() != m_height) {
+            throw std::invalid_argument("Board does not fit the batch");
+        }
+        const Lanes bit = Lanes(1) << lane;
+        const auto& plane = board.getMinePlane();
+        const int stride = board.getStride();
+        for (int y = 0; y < m_height; ++y) {
+            for (int x = 0; x < m_width; ++x) {
+                const int c = index(x, y);
+                const bool mine = (plane[y * stride + x / 64] >> (x % 64)) & 1;
+                m_mines[c] = (m_mines[c] & ~bit) | (mine ? bit : 0);
+                m_revealed[c] &= ~bit;
+                m_flags[c] &= ~bit;
+            }
+        }
+        m_loaded |= bit;
+        m_won &= ~bit;
+        m_lost &= ~bit;
+        m_counts_dirty = true;
+    }
+
+    BatchSolver::Count BatchSolver::sum(const Lanes (&bits)[8]) {
+        // 全加器组成的进位保留加法树
+        auto add = [](Lanes a, Lanes b, Lanes c, Lanes& s, Lanes& carry) {
+            const Lanes t = a ^ b;
+            s = t ^ c;
+            carry = (a & b) | (t & c);
+        };
+        Lanes s1, c1, s2, c2, s3, c3, s4, c4;
+        add(bits[0], bits[1], bits[2], s1, c1);
+        add(bits[3], bits[4], bits[5], s2, c2);
+        add(s1, s2, bits[6], s3, c3);
+        Count result;
+        result.b0 = s3 ^ bits[7];
+        const Lanes c5 = s3 & bits[7];
+        add(c1, c2, c3, s4, c4);
+        result.b1 = s4 ^ c5;
+        const Lanes c6 = s4 & c5;
+        result.b2 = c4 ^ c6;
+        result.b3 = c4 & c6;
+        return result;
+    }
+
+    void BatchSolver::updateCounts() {
+        Lanes around[8];
+        for (int c : m_cells) {
+            for (int i = 0; i < 8; ++i) {
+                around[i] = m_mines[c + m_neighbours[i]];
+            }
+            const Count n = sum(around);
+            m_numbers[c] = n;
+            m_zeros[c] = ~m_mines[c] & ~(n.b0 | n.b1 | n.b2 | n.b3);
+        }
+        m_counts_dirty = false;
+    }
+
+    void BatchSolver::reveal(int x, int y, Lanes lanes) {
+        if (m_counts_dirty) {
+            updateCounts();
+        }
+        const int c = index(x, y);
+        lanes &= getActive() & ~m_flags[c];
+        m_lost |= lanes & m_mines[c];
+        m_revealed[c] |= lanes;
+        m_flood_needed |= (lanes & m_zeros[c]) != 0;
+        flood();
+        settle();
+    }
+
+    void BatchSolver::flood() {
+        if (!m_flood_needed) {
+            return;
+        }
+        m_flood_needed = false;
+        // 扫描时就地更新，同一轮内新翻开的零格立即向后传播
+        auto step = [this](int c) {
+            Lanes open = 0;
+            for (int i = 0; i < 8; ++i) {
+                const int n = c + m_neighbours[i];
+                open |= m_revealed[n] & m_zeros[n];
+            }
+            const Lanes added = open & ~m_revealed[c];
+            m_revealed[c] |= added;
+            return added;
+        };
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (int c : m_cells) {
+                changed |= step(c) != 0;
+            }
+            for (auto it = m_cells.rbegin(); it != m_cells.rend(); ++it) {
+                changed |= step(*it) != 0;
+            }
+        }
+    }
+
+    bool BatchSolver::deducePass() {
+        const Lanes active = getActive();
+        bool changed = false;
+        Lanes covered[8], flagged[8];
+        for (int c : m_cells) {
+            const Lanes shown = m_revealed[c] & ~m_mines[c] & active;
+            if (!shown) {
+                continue;
+            }
+            Lanes unknown = 0;
+            for (int i = 0; i < 8; ++i) {
+                const int n = c + m_neighbours[i];
+                covered[i] = ~m_revealed[n];
+                flagged[i] = m_flags[n];
+                unknown |= covered[i] & ~flagged[i];
+            }
+            // 周围已没有未知格的局不用再看，剩下的局只要规则成立就一定有新进展
+            const Lanes open = shown & unknown;
+            if (!open) {
+                continue;
+            }
+            const Count& number = m_numbers[c];
+            const Lanes safe = open & equal(number, sum(flagged));
+            const Lanes mine = open & ~safe & equal(number, sum(covered));
+            if (!(safe | mine)) {
+                continue;
+            }
+            for (int i = 0; i < 8; ++i) {
+                const int n = c + m_neighbours[i];
+                const Lanes fresh = covered[i] & ~flagged[i];
+                m_revealed[n] |= safe & fresh;
+                m_flags[n] |= mine & fresh;
+                m_flood_needed |= (safe & fresh & m_zeros[n]) != 0;
+            }
+            changed = true;
+        }
+        return changed;
+    }
+
+    int BatchSolver::deduce() {
+        if (m_counts_dirty) {
+            updateCounts();
+        }
+        int rounds = 0;
+        while (getActive()) {
+            rounds += 1;
+            const bool changed = deducePass();
+            flood();
+            if (!changed) {
+                break;
+            }
+        }
+        settle();
+        return rounds;
+    }
+
+    void BatchSolver::guess(RandomRef random) {
+        if (m_counts_dirty) {
+            updateCounts();
+        }
+        const int cells = static_cast<int>(m_cells.size());
+        for (Lanes lanes = getActive(); lanes; lanes &= lanes - 1) {
+            const Lanes bit = lanes & (0 - lanes);
+            auto unknown = [&](int c) { return !((m_revealed[c] | m_flags[c]) & bit); };
+            // 未知格通常不少，先随机试几次，都落空时再按顺序统计后抽取
+            int target = -1;
+            for (int attempt = 0; attempt < 16 && target < 0; ++attempt) {
+                const int c = m_cells[random.below(cells)];
+                if (unknown(c)) {
+                    target = c;
+                }
+            }
+            if (target < 0) {
+                int total = 0;
+                for (int c : m_cells) {
+                    total += unknown(c);
+                }
+                if (total == 0) {
+                    continue;
+                }
+                int pick = static_cast<int>(random.below(total));
+                for (int c : m_cells) {
+                    if (unknown(c) && pick-- == 0) {
+                        target = c;
+                        break;
+                    }
+                }
+            }
+            m_lost |= bit & m_mines[target];
+            m_revealed[target] |= bit;
+            m_flood_needed |= (bit & m_zeros[target]) != 0;
+        }
+        flood();
+        settle();
+    }
+
+    BatchSolver::Lanes BatchSolver::play(int px, int py, RandomRef random) {
+        reveal(px, py, getActive());
+        while (true) {
+            deduce();
+            if (!getActive()) {
+                break;
+            }
+            guess(random);
+        }
+        return m_won;
+    }
+
+    void BatchSolver::settle() {
+        // 还有未翻开的非雷格的局没有结束
+        Lanes unfinished = 0;
+        for (int c : m_cells) {
+            unfinished |= ~m_revealed[c] & ~m_mines[c];
+        }
+        m_won |= m_loaded & ~m_lost & ~unfinished;
+    }
+
+    int BatchSolver::getRevealedCount(int lane) const {
+        const Lanes bit = Lanes(1) << lane;
+        int count = 0;
+        for (int c : m_cells) {
+            count += (m_revealed[c] & ~m_mines[c] & bit) != 0;
+        }
+        return count;
+    }
+}
@@ -0,0 +1,1115 @@
+#include <Board.hpp>
+#include <MineCount.hpp>
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <bit>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+static void yeild_mines(std::vector<Game::Board::Word>& mines, int stride, Game::RandomRef random, int w = 9, int h = 9, int count = 10, int x = 0, int y = 0);
+
+namespace {
+    using Word = Game::Board::Word;
+
+    // 每个线程只取一次系统熵，之后的种子由 SplitMix64 产生
+    uint64_t fresh_seed() {
+        static thread_local Game::SplitMix64 seeds(
+            (uint64_t(std::random_device{}()) << 32) ^ std::random_device{}());
+        return seeds();
+    }
+
+    // 在 mask 内把 seed 沿行向两侧填满（Kogge-Stone 填充）
+    inline Word fill_word(Word seed, Word mask) {
+        Word up = seed & mask, down = up;
+        Word pu = mask, pd = mask;
+        for (int shift = 1; shift < 64; shift <<= 1) {
+            up |= pu & (up << shift);
+            pu &= pu << shift;
+            down |= pd & (down >> shift);
+            pd &= pd >> shift;
+        }
+        return up | down;
+    }
+
+    // 第 k 个字向左右各扩一格，包括跨字的进位
+    inline Word spread_word(const Word* row, int k, int stride) {
+        Word v = row[k];
+        Word s = v | (v << 1) | (v >> 1);
+        if (k > 0) s |= row[k - 1] >> 63;
+        if (k + 1 < stride) s |= row[k + 1] << 63;
+        return s;
+    }
+}
+
+namespace Game {
+    Board::Board(int w, int h, int count)
+        : m_width(w), m_height(h), m_count(count)
+    {
+        if (w <= 0 || h <= 0) {
+            throw std::invalid_argument("Invalid dimensions");
+        }
+        m_stride = (w + WORD_BITS - 1) / WORD_BITS;
+        m_mines.resize(m_stride * h);
+        m_revealed.resize(m_stride * h);
+        m_flags.resize(m_stride * h);
+        m_zeros.resize(m_stride * h);
+        m_pending.resize(m_stride * h);
+        m_region.resize(m_stride * h);
+        m_row_prev.resize(m_stride);
+        m_row_cur.resize(m_stride);
+        m_counts.resize((w * h + 1) / 2);
+        m_row_epoch.resize(h);
+        m_tiles_x = (w + (1 << TILE_SHIFT) - 1) >> TILE_SHIFT;
+        m_blocks_x = (w + (1 << (TILE_SHIFT + BLOCK_SHIFT)) - 1) >> (TILE_SHIFT + BLOCK_SHIFT);
+        m_tiles.resize(static_cast<size_t>(m_tiles_x) * ((h + (1 << TILE_SHIFT) - 1) >> TILE_SHIFT));
+        m_blocks.resize(static_cast<size_t>(m_blocks_x) * ((h + (1 << (TILE_SHIFT + BLOCK_SHIFT)) - 1) >> (TILE_SHIFT + BLOCK_SHIFT)));
+        m_tail_mask = (w % WORD_BITS) ? (Word(1) << (w % WORD_BITS)) - 1 : ~Word(0);
+        reset();
+    }
+
+    CellState Board::getState(int x, int y) const {
+        if (isStale(y)) {
+            return m_generated ? CellState::Default : CellState::Empty;
+        }
+        if (isRevealed(x, y)) {
+            return CellState::Uncovered;
+        } else if (isPending(x, y)) {
+            return CellState::Revealing;
+        } else if (isFlagged(x, y)) {
+            return CellState::Flag;
+        }
+        return m_generated ? CellState::Default : CellState::Empty;
+    }
+
+    static const char* const ENGINE_NAMES[] = {"splitmix64", "xoshiro256", "pcg64"};
+
+    std::string BoardKey::toString() const {
+        char buffer[96];
+        std::snprintf(buffer, sizeof(buffer), "%s:%dx%d:%d:%d,%d:%016llx",
+            ENGINE_NAMES[static_cast<int>(engine)], width, height, count, x, y,
+            static_cast<unsigned long long>(seed));
+        return buffer;
+    }
+
+    BoardKey BoardKey::parse(std::string_view text) {
+        BoardKey key;
+        char name[16] = {};
+        unsigned long long seed = 0;
+        std::string str(text);
+        if (std::sscanf(str.c_str(), "%15[^:]:%dx%d:%d:%d,%d:%llx",
+                name, &key.width, &key.height, &key.count, &key.x, &key.y, &seed) != 7) {
+            throw std::invalid_argument("Invalid board key");
+        }
+        auto it = std::find_if(std::begin(ENGINE_NAMES), std::end(ENGINE_NAMES),
+            [&name](const char* engine) { return std::string_view(engine) == name; });
+        if (it == std::end(ENGINE_NAMES)) {
+            throw std::invalid_argument("Unknown random engine");
+        }
+        key.engine = static_cast<RandomKind>(it - std::begin(ENGINE_NAMES));
+        key.seed = seed;
+        return key;
+    }
+
+    Board Board::fromKey(const BoardKey& key) {
+        Board board(key.width, key.height, key.count);
+        board.generate(key);
+        return board;
+    }
+
+    void Board::generate(int px, int py) {
+        BoardKey key;
+        key.seed = fresh_seed();
+        key.width = m_width;
+        key.height = m_height;
+        key.count = m_count;
+        key.x = px;
+        key.y = py;
+        generate(key);
+    }
+
+    void Board::generate(const BoardKey& key) {
+        if (key.width != m_width || key.height != m_height || key.count != m_count) {
+            throw std::invalid_argument("Board key does not match board size");
+        }
+        switch (key.engine) {
+            case RandomKind::SplitMix64: {
+                SplitMix64 engine(key.seed);
+                generate(key.x, key.y, engine);
+                break;
+            }
+            case RandomKind::Xoshiro256: {
+                Xoshiro256 engine(key.seed);
+                generate(key.x, key.y, engine);
+                break;
+            }
+            case RandomKind::Pcg64: {
+                Pcg64 engine(key.seed);
+                generate(key.x, key.y, engine);
+                break;
+            }
+        }
+        m_key = key;
+        m_has_key = true;
+    }
+
+    void Board::generate(int px, int py, RandomRef random) {
+        ChangeScope scope(*this);
+        // 布雷本身就要遍历整张棋盘，顺便清掉所有过期的行；未布雷前插的旗子保留
+        for (int y = 0; y < m_height; ++y) {
+            freshen(y);
+        }
+        std::fill(m_mines.begin(), m_mines.end(), 0);
+        yeild_mines(m_mines, m_stride, random, m_width, m_height, m_count, px, py);
+        updateCounts();
+        labelOpenings();
+        m_generated = true;
+        m_has_key = false;
+        summarize();
+        record(CellChange::ALL_CELLS, CellState::Empty, CellState::Default);
+    }
+
+    void Board::summarize() {
+        std::fill(m_tiles.begin(), m_tiles.end(), BoardStats{});
+        std::fill(m_blocks.begin(), m_blocks.end(), BoardStats{});
+        m_flag_mine_count = 0;
+        for (int y = 0; y < m_height; ++y) {
+            for (int k = 0; k < m_stride; ++k) {
+                int i = y * m_stride + k;
+                BoardStats& tile = tileOf(k * WORD_BITS, y);
+                tile.mines += std::popcount(m_mines[i]);
+                tile.revealed += std::popcount(m_revealed[i]);
+                tile.flagged += std::popcount(m_flags[i]);
+                tile.flag_mines += std::popcount(m_flags[i] & m_mines[i]);
+            }
+        }
+        for (size_t t = 0; t < m_tiles.size(); ++t) {
+            int tx = static_cast<int>(t) % m_tiles_x, ty = static_cast<int>(t) / m_tiles_x;
+            blockOf(tx << TILE_SHIFT, ty << TILE_SHIFT) += m_tiles[t];
+            m_flag_mine_count += m_tiles[t].flag_mines;
+        }
+    }
+
+    BoardStats Board::getStats(int x0, int y0, int x1, int y1) const {
+        x0 = std::max(x0, 0);
+        y0 = std::max(y0, 0);
+        x1 = std::min(x1, m_width);
+        y1 = std::min(y1, m_height);
+        BoardStats result;
+        if (x0 >= x1 || y0 >= y1) {
+            return result;
+        }
+        result.cells = (x1 - x0) * (y1 - y0);
+
+        // 完全落在矩形内的区块直接累加（超出棋盘的部分本来就没有格子）
+        auto inside = [=, this](int bx0, int by0, int size) {
+            return bx0 >= x0 && by0 >= y0 && std::min(bx0 + size, m_width) <= x1 && std::min(by0 + size, m_height) <= y1;
+        };
+        auto scan_tile = [&](int tx, int ty) {
+            int tx0 = tx << TILE_SHIFT, ty0 = ty << TILE_SHIFT;
+            if (inside(tx0, ty0, 1 << TILE_SHIFT)) {
+                BoardStats tile = m_tiles[ty * m_tiles_x + tx];
+                tile.cells = 0;
+                result += tile;
+                return;
+            }
+            // 边缘区块按字掩码统计
+            int lo = std::max(x0, tx0) - tx0, hi = std::min(x1, tx0 + WORD_BITS) - tx0;
+            Word mask = (hi == WORD_BITS ? ~Word(0) : (Word(1) << hi) - 1) & ~((Word(1) << lo) - 1);
+            for (int y = std::max(y0, ty0); y < std::min(y1, ty0 + (1 << TILE_SHIFT)); ++y) {
+                if (isStale(y)) {
+                    continue;
+                }
+                int i = y * m_stride + tx;
+                Word mines = m_generated ? m_mines[i] & mask : 0;
+                result.mines += std::popcount(mines);
+                result.revealed += std::popcount(m_revealed[i] & mask);
+                result.flagged += std::popcount(m_flags[i] & mask);
+                result.flag_mines += std::popcount(m_flags[i] & mines);
+            }
+        };
+
+        constexpr int BLOCK = 1 << (TILE_SHIFT + BLOCK_SHIFT);
+        for (int by = y0 / BLOCK; by <= (y1 - 1) / BLOCK; ++by) {
+            for (int bx = x0 / BLOCK; bx <= (x1 - 1) / BLOCK; ++bx) {
+                if (inside(bx * BLOCK, by * BLOCK, BLOCK)) {
+                    BoardStats block = m_blocks[by * m_blocks_x + bx];
+                    block.cells = 0;
+                    result += block;
+                    continue;
+                }
+                int tx_end = std::min((bx + 1) << BLOCK_SHIFT, m_tiles_x);
+                int ty_end = std::min((by + 1) << BLOCK_SHIFT, static_cast<int>(m_tiles.size()) / m_tiles_x);
+                for (int ty = std::max(by << BLOCK_SHIFT, y0 >> TILE_SHIFT); ty < ty_end && (ty << TILE_SHIFT) < y1; ++ty) {
+                    for (int tx = std::max(bx << BLOCK_SHIFT, x0 >> TILE_SHIFT); tx < tx_end && (tx << TILE_SHIFT) < x1; ++tx) {
+                        scan_tile(tx, ty);
+                    }
+                }
+            }
+        }
+        return result;
+    }
+
+    void Board::updateCounts() {
+        count_mines(m_mines.data(), m_width, m_height, m_stride, m_counts.data(), m_zeros.data());
+    }
+
+    void Board::loadMines(std::span<const Word> mines) {
+        if (mines.size() != m_mines.size()) {
+            throw std::invalid_argument("Mine plane size mismatch");
+        }
+        ChangeScope scope(*this);
+        reset();
+        m_count = 0;
+        for (int y = 0; y < m_height; ++y) {
+            freshen(y);
+            for (int k = 0; k < m_stride; ++k) {
+                Word word = mines[y * m_stride + k];
+                if (k + 1 == m_stride) word &= m_tail_mask;
+                m_mines[y * m_stride + k] = word;
+                m_count += std::popcount(word);
+            }
+        }
+        m_uncovered = m_width * m_height - m_count;
+        updateCounts();
+        labelOpenings();
+        m_generated = true;
+        summarize();
+        record(CellChange::ALL_CELLS, CellState::Empty, CellState::Default);
+    }
+
+    void Board::snapshot(const Board& source) {
+        m_width = source.m_width;
+        m_height = source.m_height;
+        m_count = source.m_count;
+        m_stride = source.m_stride;
+        m_uncovered = source.m_uncovered;
+        m_flag_mine_count = source.m_flag_mine_count;
+        m_generated = source.m_generated;
+        m_has_key = false;
+        m_epoch = source.m_epoch;
+        m_row_epoch.assign(source.m_row_epoch.begin(), source.m_row_epoch.end());
+        m_mines.assign(source.m_mines.begin(), source.m_mines.end());
+        m_revealed.assign(source.m_revealed.begin(), source.m_revealed.end());
+        m_flags.assign(source.m_flags.begin(), source.m_flags.end());
+        m_counts.assign(source.m_counts.begin(), source.m_counts.end());
+    }
+
+    void Board::adopt(Board&& layout, int px, int py) {
+        if (!layout.m_generated || layout.m_width != m_width || layout.m_height != m_height || layout.m_count != m_count) {
+            throw std::invalid_argument("Layout does not match board");
+        }
+        ChangeScope scope(*this);
+        for (int y = 0; y < m_height; ++y) {
+            freshen(y);
+        }
+        m_mines.swap(layout.m_mines);
+        m_zeros.swap(layout.m_zeros);
+        m_counts.swap(layout.m_counts);
+        m_zero_rank.swap(layout.m_zero_rank);
+        m_zero_labels.swap(layout.m_zero_labels);
+        m_opening_offsets.swap(layout.m_opening_offsets);
+        m_opening_cells.swap(layout.m_opening_cells);
+        // 移雷的随机数取自布局自己的种子，没有种子的布局另取一个；不能用清空后的 key，否则同一点击位置总移到同一串格子
+        const uint64_t seed = layout.m_has_key ? layout.m_key.seed : fresh_seed();
+        // 布局的 key 记录的是预生成时随机选的点击位置而不是玩家的，按它重放会从错误的格子开始
+        m_key = BoardKey{};
+        m_has_key = false;
+        m_generated = true;
+        if (!clearSafeZone(px, py, seed)) {
+            generate(px, py);
+        } else {
+            summarize();
+            record(CellChange::ALL_CELLS, CellState::Empty, CellState::Default);
+        }
+    }
+
+    bool Board::clearSafeZone(int px, int py, uint64_t seed) {
+        // 安全区为点击格和它的邻居
+        std::vector<int> moved;
+        auto collect = [this, &moved](int x, int y) {
+            if (testBit(m_mines, x, y)) moved.push_back(index(x, y));
+        };
+        collect(px, py);
+        forEachNeighbour(px, py, collect);
+        if (moved.empty()) {
+            return true;
+        }
+
+        // 目标格离点击至少 3 格，且自身和邻居都不是零格：零格平面和所有开口都不受影响
+        auto fits = [this, px, py](int x, int y) {
+            if (std::max(std::abs(x - px), std::abs(y - py)) < 3 || testBit(m_mines, x, y) || testBit(m_zeros, x, y)) {
+                return false;
+            }
+            bool touches_zero = false;
+            forEachNeighbour(x, y, [this, &touches_zero](int nx, int ny) { touches_zero |= testBit(m_zeros, nx, ny); });
+            return !touches_zero;
+        };
+        SplitMix64 random(SplitMix64::mix(seed ^ (uint64_t(uint32_t(py)) << 32 | uint32_t(px))));
+        RandomRef pick(random);
+        const int cells = m_width * m_height;
+        std::vector<int> targets;
+        for (size_t k = 0; k < moved.size(); ++k) {
+            int target = -1;
+            for (int attempt = 0; attempt < 64 && target < 0; ++attempt) {
+                int i = static_cast<int>(pick.below(cells));
+                if (fits(i % m_width, i / m_width)) target = i;
+            }
+            // 随机尝试失败时从随机起点顺序查找
+            for (int n = 0, i = static_cast<int>(pick.below(cells)); n < cells && target < 0; ++n, i = (i + 1) % cells) {
+                if (fits(i % m_width, i / m_width)) target = i;
+            }
+            if (target < 0) {
+                for (int i : targets) clearBit(m_mines, i % m_width, i / m_width);
+                return false;
+            }
+            setBit(m_mines, target % m_width, target / m_width);
+            targets.push_back(target);
+        }
+
+        // 安全区附近受影响的开口先取消编号，翻开时改用位平面扩张
+        auto unlabel = [this](int label) {
+            for (int i : getOpening(label)) {
+                int x = i % m_width, y = i / m_width;
+                if (testBit(m_zeros, x, y)) {
+                    int k = y * m_stride + (x >> 6);
+                    m_zero_labels[m_zero_rank[k] + std::popcount(m_zeros[k] & ((Word(1) << (x & 63)) - 1))] = -1;
+                }
+            }
+        };
+        for (int y = std::max(py - 3, 0); y <= std::min(py + 3, m_height - 1); ++y) {
+            for (int x = std::max(px - 3, 0); x <= std::min(px + 3, m_width - 1); ++x) {
+                int label = getOpeningLabel(x, y);
+                if (label >= 0) unlabel(label);
+            }
+        }
+
+        auto patch = [this](int i, int delta) {
+            forEachNeighbour(i % m_width, i / m_width, [this, delta](int nx, int ny) { addCount(nx, ny, delta); });
+        };
+        for (int i : targets) patch(i, 1);
+        for (int i : moved) {
+            clearBit(m_mines, i % m_width, i / m_width);
+            patch(i, -1);
+        }
+
+        // 只有点击周围 5x5 可能出现新的零格，按下标顺序插入到编号表中，编号为 -1
+        std::vector<int> fresh;
+        for (int y = std::max(py - 2, 0); y <= std::min(py + 2, m_height - 1); ++y) {
+            for (int x = std::max(px - 2, 0); x <= std::min(px + 2, m_width - 1); ++x) {
+                if (!testBit(m_zeros, x, y) && !testBit(m_mines, x, y) && getMineCount(x, y) == 0) {
+                    setBit(m_zeros, x, y);
+                    fresh.push_back(index(x, y));
+                }
+            }
+        }
+        if (!fresh.empty() && !m_zero_rank.empty()) {
+            int first = (fresh.front() / m_width) * m_stride + (fresh.front() % m_width >> 6);
+            uint32_t total = m_zero_rank[first];
+            for (size_t k = first; k < m_zeros.size(); ++k) {
+                m_zero_rank[k] = total;
+                total += std::popcount(m_zeros[k]);
+            }
+            // 从后往前把各段后移，labelOpenings 预留了容量，不会重新分配
+            size_t src = m_zero_labels.size(), dst = total;
+            m_zero_labels.resize(total);
+            for (auto it = fresh.rbegin(); it != fresh.rend(); ++it) {
+                int x = *it % m_width, y = *it / m_width;
+                int k = y * m_stride + (x >> 6);
+                size_t rank = m_zero_rank[k] + std::popcount(m_zeros[k] & ((Word(1) << (x & 63)) - 1));
+                size_t n = dst - rank - 1;
+                std::move_backward(m_zero_labels.begin() + (src - n), m_zero_labels.begin() + src, m_zero_labels.begin() + dst);
+                src -= n;
+                dst = rank;
+                m_zero_labels[dst] = -1;
+            }
+        }
+        return true;
+    }
+
+    int Board::getOpeningLabel(int x, int y) const {
+        if (!testBit(m_zeros, x, y) || m_zero_labels.empty()) {
+            return -1;
+        }
+        int k = y * m_stride + (x >> 6);
+        return m_zero_labels[m_zero_rank[k] + std::popcount(m_zeros[k] & ((Word(1) << (x & 63)) - 1))];
+    }
+
+    void Board::labelOpenings() {
+        m_zero_rank.resize(m_zeros.size());
+        uint32_t total = 0;
+        for (size_t k = 0; k < m_zeros.size(); ++k) {
+            m_zero_rank[k] = total;
+            total += std::popcount(m_zeros[k]);
+        }
+
+        // 并查集，根总是连通块中最小的下标
+        auto& parent = m_zero_labels;
+        // 预留安全区修补时插入新零格的空间
+        parent.reserve(total + 25);
+        parent.resize(total);
+        auto find = [&parent](int a) {
+            while (parent[a] != a) {
+                parent[a] = parent[parent[a]];
+                a = parent[a];
+            }
+            return a;
+        };
+        auto rank_of = [this](int x, int y) {
+            int k = y * m_stride + (x >> 6);
+            return static_cast<int>(m_zero_rank[k] + std::popcount(m_zeros[k] & ((Word(1) << (x & 63)) - 1)));
+        };
+
+        auto unite = [&parent, &find](int a, int b) {
+            a = find(a);
+            b = find(b);
+            if (a < b) parent[b] = a; else parent[a] = b;
+        };
+
+        int r = 0;
+        for (int y = 0; y < m_height; ++y) {
+            for (int k = 0; k < m_stride; ++k) {
+                for (Word bits = m_zeros[y * m_stride + k]; bits; bits &= bits - 1, ++r) {
+                    int x = k * WORD_BITS + std::countr_zero(bits);
+                    parent[r] = r;
+                    // 只需与已扫描过的左、左上、上、右上相连，上方为零格时左上和右上已与其连通
+                    if (x > 0 && testBit(m_zeros, x - 1, y)) {
+                        unite(r, r - 1);
+                    }
+                    if (y == 0) {
+                        continue;
+                    }
+                    if (testBit(m_zeros, x, y - 1)) {
+                        unite(r, rank_of(x, y - 1));
+                    } else {
+                        if (x > 0 && testBit(m_zeros, x - 1, y - 1)) unite(r, rank_of(x - 1, y - 1));
+                        if (x + 1 < m_width && testBit(m_zeros, x + 1, y - 1)) unite(r, rank_of(x + 1, y - 1));
+                    }
+                }
+            }
+        }
+
+        // 父节点下标总小于自身，按升序一遍即可让所有节点直接指向根
+        for (int r = 0; r < static_cast<int>(total); ++r) {
+            parent[r] = parent[parent[r]];
+        }
+        // 压缩为连续编号，先以负数暂存编号避免与父指针混淆
+        int regions = 0;
+        for (int r = 0; r < static_cast<int>(total); ++r) {
+            parent[r] = parent[r] == r ? -(regions++) - 1 : parent[parent[r]];
+        }
+        for (auto& label : parent) {
+            label = -label - 1;
+        }
+
+        // 两遍计数排序：零格加上与之相邻的数字格
+        auto for_each_member = [this](auto&& visit) {
+            int r = 0;
+            for (int y = 0; y < m_height; ++y) {
+                for (int k = 0; k < m_stride; ++k) {
+                    for (Word bits = m_zeros[y * m_stride + k]; bits; bits &= bits - 1, ++r) {
+                        visit(m_zero_labels[r], index(k * WORD_BITS + std::countr_zero(bits), y));
+                    }
+                }
+            }
+            for (int y = 0; y < m_height; ++y) {
+                const Word* above = y > 0 ? &m_zeros[(y - 1) * m_stride] : nullptr;
+                const Word* below = y + 1 < m_height ? &m_zeros[(y + 1) * m_stride] : nullptr;
+                for (int k = 0; k < m_stride; ++k) {
+                    int i = y * m_stride + k;
+                    Word rim = spread_word(&m_zeros[y * m_stride], k, m_stride);
+                    if (above) rim |= spread_word(above, k, m_stride);
+                    if (below) rim |= spread_word(below, k, m_stride);
+                    rim &= ~m_zeros[i] & ~m_mines[i];
+                    if (k + 1 == m_stride) rim &= m_tail_mask;
+                    for (; rim; rim &= rim - 1) {
+                        int x = k * WORD_BITS + std::countr_zero(rim);
+                        int seen[8], n = 0;
+                        forEachNeighbour(x, y, [&](int nx, int ny) {
+                            int label = getOpeningLabel(nx, ny);
+                            if (label >= 0 && std::find(seen, seen + n, label) == seen + n) {
+                                seen[n++] = label;
+                                visit(label, index(x, y));
+                            }
+                        });
+                    }
+                }
+            }
+        };
+
+        m_opening_offsets.assign(regions + 1, 0);
+        for_each_member([this](int label, int) { ++m_opening_offsets[label + 1]; });
+        for (int i = 0; i < regions; ++i) {
+            m_opening_offsets[i + 1] += m_opening_offsets[i];
+        }
+        m_opening_cells.resize(m_opening_offsets.back());
+        std::vector<int> fill(m_opening_offsets.begin(), m_opening_offsets.end() - 1);
+        for_each_member([this, &fill](int label, int i) { m_opening_cells[fill[label]++] = i; });
+    }
+
+    void Board::freshen(int y) {
+        if (!isStale(y)) {
+            return;
+        }
+        std::fill_n(m_revealed.begin() + y * m_stride, m_stride, 0);
+        std::fill_n(m_flags.begin() + y * m_stride, m_stride, 0);
+        std::fill_n(m_pending.begin() + y * m_stride, m_stride, 0);
+        m_row_epoch[y] = m_epoch;
+    }
+
+    void Board::reset() {
+        ChangeScope scope(*this);
+        // 纪元回绕时所有行重新标记为过期
+        if (++m_epoch == 0) {
+            m_epoch = 1;
+            std::fill(m_row_epoch.begin(), m_row_epoch.end(), 0);
+        }
+        m_zero_labels.clear();
+        m_opening_offsets.assign(1, 0);
+        m_opening_cells.clear();
+        m_layer.clear();
+        m_next_layer.clear();
+        m_layer_pos = 0;
+        clearDelta();
+        m_uncovered = m_width * m_height - m_count;
+        m_flag_mine_count = 0;
+        // 区块数只有格子数的 1/4096，清零不影响重置的开销
+        std::fill(m_tiles.begin(), m_tiles.end(), BoardStats{});
+        std::fill(m_blocks.begin(), m_blocks.end(), BoardStats{});
+        m_generated = false;
+        m_has_key = false;
+        record(CellChange::ALL_CELLS, CellState::Default, CellState::Empty);
+    }
+
+    BoardResult Board::uncover(int x, int y) {
+        ChangeScope scope(*this);
+        if (isRevealed(x, y)) {
+            return BoardResult::None;
+        }
+        record(index(x, y), getState(x, y), CellState::Uncovered);
+        freshen(y);
+        setBit(m_revealed, x, y);
+        tally(x, y, 1, 0, 0);
+        if (isMine(x, y)) {
+            return BoardResult::Lose;
+        }
+        m_uncovered -= 1;
+        return m_uncovered == 0 ? BoardResult::Win : BoardResult::None;
+    }
+
+    void Board::setState(int x, int y, CellState state) {
+        ChangeScope scope(*this);
+        const CellState before = getState(x, y);
+        if (!m_generated || before == state) {
+            return;
+        }
+        freshen(y);
+        const int on_mine = isMine(x, y);
+        if (testBit(m_revealed, x, y)) {
+            clearBit(m_revealed, x, y);
+            tally(x, y, -1, 0, 0);
+            m_uncovered += !on_mine;
+        }
+        if (testBit(m_flags, x, y)) {
+            clearBit(m_flags, x, y);
+            tally(x, y, 0, -1, -on_mine);
+            m_flag_mine_count -= on_mine;
+        }
+        clearBit(m_pending, x, y);
+        switch (state) {
+            case CellState::Uncovered:
+                setBit(m_revealed, x, y);
+                tally(x, y, 1, 0, 0);
+                m_uncovered -= !on_mine;
+                break;
+            case CellState::Flag:
+                setBit(m_flags, x, y);
+                tally(x, y, 0, 1, on_mine);
+                m_flag_mine_count += on_mine;
+                break;
+            case CellState::Revealing:
+                // 只置排队位，不进入 BFS 队列
+                setBit(m_pending, x, y);
+                break;
+            default:
+                break;
+        }
+        record(index(x, y), before, getState(x, y));
+    }
+
+    void Board::commitDelta() {
+        size_t total = m_changes.size();
+        for (int y = m_delta_first; y <= m_delta_last; ++y) {
+            for (int k = 0; k < m_stride; ++k) {
+                int added = std::popcount(m_region[y * m_stride + k]);
+                if (added) {
+                    tileOf(k * WORD_BITS, y).revealed += added;
+                    blockOf(k * WORD_BITS, y).revealed += added;
+                    total += added;
+                }
+            }
+        }
+        if (!m_record_changes) {
+            return;
+        }
+        m_changes.reserve(total);
+        for (int y = m_delta_first; y <= m_delta_last; ++y) {
+            for (int k = 0; k < m_stride; ++k) {
+                for (Word word = m_region[y * m_stride + k]; word; word &= word - 1) {
+                    m_changes.push_back({index(k * WORD_BITS + std::countr_zero(word), y), CellState::Default, CellState::Uncovered});
+                }
+            }
+        }
+    }
+
+    void Board::clearDelta() {
+        for (int y = m_delta_first; y <= m_delta_last; ++y) {
+            std::fill_n(m_region.begin() + y * m_stride, m_stride, 0);
+        }
+        m_delta_first = 0;
+        m_delta_last = -1;
+    }
+
+    bool Board::growRow(int y, Band& band) {
+        Word* row = &m_region[y * m_stride];
+        const Word* above = y > band.top ? &m_region[(y - 1) * m_stride] : band.above;
+        const Word* below = y + 1 < band.bottom ? &m_region[(y + 1) * m_stride] : band.below;
+        Word* next = band.scratch;
+        bool changed = false;
+
+        // 上下左右八邻域作为种子
+        for (int k = 0; k < m_stride; ++k) {
+            Word seed = spread_word(row, k, m_stride);
+            if (above) seed |= spread_word(above, k, m_stride);
+            if (below) seed |= spread_word(below, k, m_stride);
+            next[k] = fill_word(seed, passable(y * m_stride + k));
+        }
+        // 行内跨字连通
+        for (int k = 1; k < m_stride; ++k) {
+            if (next[k - 1] >> 63) {
+                next[k] = fill_word(next[k] | 1, passable(y * m_stride + k));
+            }
+        }
+        for (int k = m_stride - 2; k >= 0; --k) {
+            if (next[k + 1] & 1) {
+                next[k] = fill_word(next[k] | (Word(1) << 63), passable(y * m_stride + k));
+            }
+        }
+        for (int k = 0; k < m_stride; ++k) {
+            if (next[k] != row[k]) {
+                row[k] = next[k];
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    bool Board::floodBand(Band& band) {
+        auto any = [this](const Word* row) {
+            return row && std::any_of(row, row + m_stride, [](Word w) { return w != 0; });
+        };
+        // 相邻条带传来的前沿
+        if (any(band.above)) {
+            band.first = std::min(band.first, band.top);
+            band.last = std::max(band.last, band.top);
+        }
+        if (any(band.below)) {
+            band.first = std::min(band.first, band.bottom - 1);
+            band.last = std::max(band.last, band.bottom - 1);
+        }
+        if (band.first > band.last) {
+            return false;
+        }
+
+        // 上下来回扫描直到不再变化，扫描范围随区域增长而延伸
+        bool any_change = false;
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (int y = std::max(band.first - 1, band.top); y <= std::min(band.last + 1, band.bottom - 1); ++y) {
+                if (growRow(y, band)) {
+                    changed = true;
+                    band.first = std::min(band.first, y);
+                    band.last = std::max(band.last, y);
+                }
+            }
+            for (int y = std::min(band.last + 1, band.bottom - 1); y >= std::max(band.first - 1, band.top); --y) {
+                if (growRow(y, band)) {
+                    changed = true;
+                    band.first = std::min(band.first, y);
+                    band.last = std::max(band.last, y);
+                }
+            }
+            any_change |= changed;
+        }
+        return any_change;
+    }
+
+    void Board::borderBand(Band& band) {
+        band.uncovered = 0;
+        if (band.first > band.last) {
+            return;
+        }
+        int start = std::max(band.first - 1, band.top);
+        int end = std::min(band.last + 1, band.bottom - 1);
+        band.first = start;
+        band.last = end;
+
+        // 结果原地写回 m_region，上一行的原始值保存在 prev 中
+        if (start == band.top && band.above) {
+            std::copy_n(band.above, m_stride, band.prev);
+        } else {
+            std::fill_n(band.prev, m_stride, 0);
+        }
+        Word* prev = band.prev;
+        Word* cur = band.scratch;
+        for (int y = start; y <= end; ++y) {
+            Word* row = &m_region[y * m_stride];
+            const Word* below = y + 1 < band.bottom ? &m_region[(y + 1) * m_stride] : band.below;
+            std::copy_n(row, m_stride, cur);
+            for (int k = 0; k < m_stride; ++k) {
+                int i = y * m_stride + k;
+                Word around = spread_word(prev, k, m_stride) | spread_word(cur, k, m_stride);
+                if (below) around |= spread_word(below, k, m_stride);
+                Word add = around & ~m_mines[i] & ~m_flags[i] & ~m_revealed[i] & ~m_pending[i];
+                if (k + 1 == m_stride) add &= m_tail_mask;
+                row[k] = add;
+                m_revealed[i] |= add;
+                band.uncovered += std::popcount(add);
+            }
+            std::swap(prev, cur);
+        }
+    }
+
+    void Board::floodRegion(int first, int last) {
+        int workers = 1;
+        if (m_parallel_threshold >= 0 && m_width * m_height >= m_parallel_threshold) {
+            // 每条至少 32 行
+            workers = std::clamp(static_cast<int>(std::thread::hardware_concurrency()), 1, std::max(m_height / 32, 1));
+        }
+        if (workers > 1) {
+            floodRegionParallel(workers, first, last);
+            return;
+        }
+
+        Band band{0, m_height, first, last, nullptr, nullptr, m_row_cur.data(), m_row_prev.data(), 0};
+        floodBand(band);
+        borderBand(band);
+        m_uncovered -= band.uncovered;
+        m_delta_first = band.first;
+        m_delta_last = band.last;
+    }
+
+    void Board::floodRegionParallel(int workers, int first, int last) {
+        // 每条带两行边缘副本和两行临时缓冲
+        std::vector<Word> buffers(static_cast<size_t>(workers) * 4 * m_stride);
+        std::vector<Band> bands(workers);
+        for (int b = 0; b < workers; ++b) {
+            Word* base = buffers.data() + static_cast<size_t>(b) * 4 * m_stride;
+            int top = m_height * b / workers;
+            int bottom = m_height * (b + 1) / workers;
+            bool seeded = first < bottom && last >= top;
+            bands[b] = Band{
+                top, bottom,
+                seeded ? std::max(first, top) : m_height, seeded ? std::min(last, bottom - 1) : -1,
+                b > 0 ? base : nullptr,
+                b + 1 < workers ? base + m_stride : nullptr,
+                base + 2 * m_stride,
+                base + 3 * m_stride,
+                0
+            };
+        }
+
+        // 每轮：复制相邻边缘行 -> 各自扩张 -> 汇总是否有变化，直到一轮内没有任何条带变化
+        std::barrier sync(workers);
+        std::atomic_bool changed = false;
+        auto run = [&](int b) {
+            Band& band = bands[b];
+            while (true) {
+                if (band.above) std::copy_n(&m_region[(band.top - 1) * m_stride], m_stride, band.above);
+                if (band.below) std::copy_n(&m_region[band.bottom * m_stride], m_stride, band.below);
+                sync.arrive_and_wait();
+                if (floodBand(band)) {
+                    changed.store(true, std::memory_order_relaxed);
+                }
+                sync.arrive_and_wait();
+                bool again = changed.load(std::memory_order_relaxed);
+                sync.arrive_and_wait();
+                if (b == 0) {
+                    changed.store(false, std::memory_order_relaxed);
+                }
+                if (!again) {
+                    break;
+                }
+            }
+            // 边缘副本即为最后一轮的原始值
+            borderBand(band);
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(workers - 1);
+        for (int b = 1; b < workers; ++b) {
+            threads.emplace_back(run, b);
+        }
+        run(0);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        m_delta_first = m_height;
+        m_delta_last = -1;
+        for (auto& band : bands) {
+            m_uncovered -= band.uncovered;
+            if (band.first <= band.last) {
+                m_delta_first = std::min(m_delta_first, band.first);
+                m_delta_last = std::max(m_delta_last, band.last);
+            }
+        }
+        if (m_delta_last < 0) {
+            m_delta_first = 0;
+        }
+    }
+
+    bool Board::revealOpening(int label) {
+        if (label < 0) {
+            return false;
+        }
+        auto cells = getOpening(label);
+        int first = m_height, last = -1;
+        for (int i : cells) {
+            int x = i % m_width, y = i / m_width;
+            if (isFlagged(x, y) || isPending(x, y) || (isRevealed(x, y) && testBit(m_zeros, x, y))) {
+                return false;
+            }
+            first = std::min(first, y);
+            last = std::max(last, y);
+        }
+
+        m_delta_first = first;
+        m_delta_last = last;
+        for (int i : cells) {
+            int x = i % m_width, y = i / m_width;
+            if (!isRevealed(x, y)) {
+                setBit(m_revealed, x, y);
+                setBit(m_region, x, y);
+                m_uncovered -= 1;
+            }
+        }
+        return true;
+    }
+
+    BoardResult Board::reveal(int px, int py) {
+        ChangeScope scope(*this);
+        clearDelta();
+        if (!contains(px, py) || isMine(px, py) || isRevealed(px, py) || isFlagged(px, py) || isPending(px, py)) {
+            return BoardResult::None;
+        }
+
+        m_delta_first = m_delta_last = py;
+        if (getMineCount(px, py) > 0) {
+            setBit(m_region, px, py);
+            return uncover(px, py);
+        }
+
+        int label = getOpeningLabel(px, py);
+        int size = label >= 0 ? static_cast<int>(getOpening(label).size()) : 0;
+        if (label >= 0 && m_stream_threshold >= 0 && size > m_stream_threshold) {
+            beginStream(px, py);
+            return BoardResult::None;
+        }
+        // 超大开口交给多线程扩张，比逐格复制更快
+        bool parallel = m_parallel_threshold >= 0 && size >= m_parallel_threshold;
+        if (!parallel && revealOpening(label)) {
+            commitDelta();
+            return m_uncovered == 0 ? BoardResult::Win : BoardResult::None;
+        }
+
+        setBit(m_region, px, py);
+        floodRegion(py, py);
+        commitDelta();
+        return m_uncovered == 0 ? BoardResult::Win : BoardResult::None;
+    }
+
+    BoardResult Board::chord(int px, int py) {
+        ChangeScope scope(*this);
+        clearDelta();
+        if (!m_generated || !contains(px, py) || !isRevealed(px, py) || isMine(px, py)) {
+            return BoardResult::None;
+        }
+        int count = getMineCount(px, py);
+        int flags = 0;
+        forEachNeighbour(px, py, [this, &flags](int x, int y) { flags += isFlagged(x, y); });
+        if (count == 0 || flags != count) {
+            return BoardResult::None;
+        }
+
+        // 零格邻居作为同一次扩张的种子，其余邻居直接翻开
+        const int y0 = std::max(py - 1, 0), y1 = std::min(py + 1, m_height - 1);
+        bool flood = false, lost = false;
+        forEachNeighbour(px, py, [this, &flood](int x, int y) {
+            if (!isFlagged(x, y) && !isRevealed(x, y) && !isPending(x, y) && testBit(m_zeros, x, y)) {
+                setBit(m_region, x, y);
+                flood = true;
+            }
+        });
+        if (flood) {
+            floodRegion(y0, y1);
+            commitDelta();
+        }
+        m_delta_first = std::min(flood ? m_delta_first : y0, y0);
+        m_delta_last = std::max(flood ? m_delta_last : y1, y1);
+        forEachNeighbour(px, py, [this, &lost](int x, int y) {
+            if (!isFlagged(x, y) && !isRevealed(x, y) && !isPending(x, y)) {
+                setBit(m_region, x, y);
+                lost |= uncover(x, y) == BoardResult::Lose;
+            }
+        });
+        if (lost) {
+            return BoardResult::Lose;
+        }
+        return m_uncovered == 0 ? BoardResult::Win : BoardResult::None;
+    }
+
+    void Board::beginStream(int x, int y) {
+        record(index(x, y), CellState::Default, CellState::Revealing);
+        setBit(m_pending, x, y);
+        m_next_layer.push_back(index(x, y));
+    }
+
+    BoardResult Board::revealStep(std::chrono::microseconds budget) {
+        ChangeScope scope(*this);
+        if (!isRevealing()) {
+            return BoardResult::None;
+        }
+        clearDelta();
+        m_delta_first = m_height;
+
+        // 每处理一批格子检查一次时间，保证每帧至少前进一批
+        constexpr size_t BATCH = 256;
+        const auto deadline = std::chrono::steady_clock::now() + budget;
+        do {
+            if (m_layer_pos == m_layer.size()) {
+                std::swap(m_layer, m_next_layer);
+                m_next_layer.clear();
+                m_layer_pos = 0;
+            }
+            size_t end = std::min(m_layer.size(), m_layer_pos + BATCH);
+            for (; m_layer_pos < end; ++m_layer_pos) {
+                int i = m_layer[m_layer_pos];
+                int x = i % m_width, y = i / m_width;
+                clearBit(m_pending, x, y);
+                // 期间可能已被其他操作翻开
+                if (isRevealed(x, y)) {
+                    continue;
+                }
+                record(i, CellState::Revealing, CellState::Uncovered);
+                setBit(m_revealed, x, y);
+                tally(x, y, 1, 0, 0);
+                setBit(m_region, x, y);
+                m_delta_first = std::min(m_delta_first, y);
+                m_delta_last = std::max(m_delta_last, y);
+                m_uncovered -= 1;
+                if (getMineCount(x, y) > 0) {
+                    continue;
+                }
+                forEachNeighbour(x, y, [this](int nx, int ny) {
+                    if (!isMine(nx, ny) && !isRevealed(nx, ny) && !isFlagged(nx, ny) && !isPending(nx, ny)) {
+                        record(index(nx, ny), CellState::Default, CellState::Revealing);
+                        setBit(m_pending, nx, ny);
+                        m_next_layer.push_back(index(nx, ny));
+                    }
+                });
+            }
+        } while (isRevealing() && std::chrono::steady_clock::now() < deadline);
+
+        if (m_delta_last < 0) {
+            m_delta_first = 0;
+        }
+        return m_uncovered == 0 ? BoardResult::Win : BoardResult::None;
+    }
+
+    BoardResult Board::leftClick(int x, int y) {
+        ChangeScope scope(*this);
+        if (isFlagged(x, y) || isRevealed(x, y) || isPending(x, y)) {
+            return BoardResult::None;
+        }
+        if (!m_generated) {
+            generate(x, y);
+        }
+        if (isMine(x, y)) {
+            return uncover(x, y);
+        }
+        return reveal(x, y);
+    }
+
+    BoardResult Board::leftClick(int x, int y, Board&& layout) {
+        ChangeScope scope(*this);
+        if (!m_generated && !isFlagged(x, y)) {
+            adopt(std::move(layout), x, y);
+        }
+        return leftClick(x, y);
+    }
+
+    BoardResult Board::rightClick(int x, int y) {
+        ChangeScope scope(*this);
+        if (isRevealed(x, y) || isPending(x, y)) {
+            return BoardResult::None;
+        }
+        freshen(y);
+        const CellState unflagged = m_generated ? CellState::Default : CellState::Empty;
+        const int on_mine = isMine(x, y);
+        if (isFlagged(x, y)) {
+            clearBit(m_flags, x, y);
+            record(index(x, y), CellState::Flag, unflagged);
+            tally(x, y, 0, -1, -on_mine);
+            m_flag_mine_count -= on_mine;
+            return BoardResult::None;
+        }
+        setBit(m_flags, x, y);
+        record(index(x, y), unflagged, CellState::Flag);
+        tally(x, y, 0, 1, on_mine);
+        m_flag_mine_count += on_mine;
+        return m_flag_mine_count == m_count ? BoardResult::Win : BoardResult::None;
+    }
+}
+
+static void yeild_mines(std::vector<Game::Board::Word>& mines, int stride, Game::RandomRef random, int w, int h, int count, int px, int py) {
+    if (count == 0) {
+        throw std::invalid_argument("Invalid mine count");
+    } else if(w*h - 9 < count) {
+        throw std::invalid_argument("Too many mines");
+    } else {
+        // 安全区裁剪到棋盘内，候选格按行优先编号并跳过安全区，不生成候选表
+        int sx0 = std::max(px - 1, 0), sx1 = std::min(px + 1, w - 1);
+        int sy0 = std::max(py - 1, 0), sy1 = std::min(py + 1, h - 1);
+        int sw = sx1 - sx0 + 1;
+        int before = sy0 * w;
+        int band = (sy1 - sy0 + 1) * (w - sw);
+        int n = w * h - sw * (sy1 - sy0 + 1);
+        auto cell_of = [=](int r) {
+            if (r < before) {
+                return r;
+            }
+            r -= before;
+            if (r < band) {
+                int c = r % (w - sw);
+                return (sy0 + r / (w - sw)) * w + (c < sx0 ? c : c + sw);
+            }
+            return (sy1 + 1) * w + (r - band);
+        };
+
+        // Floyd 抽样：恰好 count 次抽取，用雷的位平面判断是否已选中
+        auto word_of = [&](int i) -> Game::Board::Word& { return mines[(i / w) * stride + (i % w) / 64]; };
+        auto bit_of = [&](int i) { return Game::Board::Word(1) << ((i % w) % 64); };
+        for (int j = n - count; j < n; ++j) {
+            int i = cell_of(static_cast<int>(random.below(j + 1)));
+            if (word_of(i) & bit_of(i)) {
+                i = cell_of(j);
+            }
+            word_of(i) |= bit_of(i);
+        }
+    }
+}
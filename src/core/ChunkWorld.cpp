@@ -0,0 +1,402 @@
+#include <ChunkWorld.hpp>
+#include <MineCount.hpp>
+#include <Random.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <system_error>
+
+namespace Game {
+    namespace {
+        constexpr int HALO = ChunkWorld::CHUNK + 2;
+        constexpr int HALO_STRIDE = 2;
+        // 内存中每个压缩区块在数据之外的开销（哈希表节点、顺序记录），粗略估计
+        constexpr std::size_t COLD_OVERHEAD = 96;
+
+        // 按字游程编码两张位平面（共 2 * CHUNK 个字）：每段一个标记字节，高 2 位为类型，低 6 位为字数减一
+        // 翻开的区域大多是整字全 1，未碰过的行是 0，只有边缘的字需要原样保存
+        enum : uint8_t { RUN_ZERO = 0, RUN_ONES = 1, RUN_LITERAL = 2 };
+
+        void encode(const ChunkWorld::Word* words, int n, std::vector<uint8_t>& out) {
+            using Word = ChunkWorld::Word;
+            out.clear();
+            auto type_of = [](Word w) -> uint8_t { return w == 0 ? RUN_ZERO : w == ~Word(0) ? RUN_ONES : RUN_LITERAL; };
+            for (int i = 0; i < n;) {
+                const uint8_t type = type_of(words[i]);
+                int length = 1;
+                while (i + length < n && length < 64 && type_of(words[i + length]) == type) {
+                    ++length;
+                }
+                out.push_back(static_cast<uint8_t>(type << 6 | (length - 1)));
+                if (type == RUN_LITERAL) {
+                    for (int k = 0; k < length; ++k) {
+                        for (int b = 0; b < 8; ++b) {
+                            out.push_back(static_cast<uint8_t>(words[i + k] >> (b * 8)));
+                        }
+                    }
+                }
+                i += length;
+            }
+        }
+
+        bool decode(const uint8_t* data, std::size_t size, ChunkWorld::Word* words, int n) {
+            using Word = ChunkWorld::Word;
+            std::size_t pos = 0;
+            int i = 0;
+            while (pos < size && i < n) {
+                const uint8_t type = data[pos] >> 6;
+                const int length = (data[pos] & 63) + 1;
+                ++pos;
+                if (i + length > n) {
+                    return false;
+                }
+                for (int k = 0; k < length; ++k, ++i) {
+                    if (type == RUN_LITERAL) {
+                        if (pos + 8 > size) {
+                            return false;
+                        }
+                        Word w = 0;
+                        for (int b = 0; b < 8; ++b) {
+                            w |= Word(data[pos++]) << (b * 8);
+                        }
+                        words[i] = w;
+                    } else {
+                        words[i] = type == RUN_ONES ? ~Word(0) : 0;
+                    }
+                }
+            }
+            return i == n && pos == size;
+        }
+    }
+
+    // 追加写入的临时文件，区块读回后原位置不再复用；随世界析构删除
+    struct ChunkWorld::SpillFile {
+        std::filesystem::path path;
+        std::fstream stream;
+        int64_t end = 0;
+
+        SpillFile() {
+            std::error_code error;
+            const auto dir = std::filesystem::temp_directory_path(error);
+            if (error) {
+                return;
+            }
+            std::random_device device;
+            const uint64_t tag = (uint64_t(device()) << 32) ^ device();
+            char name[48];
+            std::snprintf(name, sizeof(name), "minesweeper-%016llx.chunks", static_cast<unsigned long long>(tag));
+            path = dir / name;
+            stream.open(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+        }
+        ~SpillFile() {
+            stream.close();
+            if (!path.empty()) {
+                std::error_code error;
+                std::filesystem::remove(path, error);
+            }
+        }
+    };
+
+    ChunkWorld::ChunkWorld(uint64_t seed, double density, std::size_t memory_budget)
+        : m_seed(seed), m_density(density) {
+        if (!(density > 0.0 && density < 1.0)) {
+            throw std::invalid_argument("Mine density must be in (0, 1)");
+        }
+        // 2^64 * density，density < 1 时不会溢出
+        m_threshold = static_cast<uint64_t>(std::ldexp(density, 64));
+        // 四分之一留给压缩区块；常驻区块至少容纳一个区块和它的 8 个邻居
+        m_cold_budget = memory_budget / 4;
+        m_max_chunks = std::max<std::size_t>((memory_budget - m_cold_budget) / sizeof(Chunk), 9);
+    }
+
+    ChunkWorld::~ChunkWorld() = default;
+    ChunkWorld::ChunkWorld(ChunkWorld&&) noexcept = default;
+    ChunkWorld& ChunkWorld::operator=(ChunkWorld&&) noexcept = default;
+
+    bool ChunkWorld::isMine(int64_t x, int64_t y) const {
+        if (m_started && x >= m_safe_x - 1 && x <= m_safe_x + 1 && y >= m_safe_y - 1 && y <= m_safe_y + 1) {
+            return false;
+        }
+        uint64_t h = SplitMix64::mix(static_cast<uint64_t>(x) ^ SplitMix64::mix(static_cast<uint64_t>(y) ^ m_seed));
+        return h < m_threshold;
+    }
+
+    void ChunkWorld::build(Chunk& chunk, int64_t cx, int64_t cy) const {
+        const int64_t x0 = cx * CHUNK, y0 = cy * CHUNK;
+        // 带一圈邻居的 66x66 平面，邻居区块只按哈希取边缘那一行/列，不必加载
+        Word halo[HALO * HALO_STRIDE] = {};
+        for (int y = 0; y < HALO; ++y) {
+            for (int x = 0; x < HALO; ++x) {
+                if (isMine(x0 + x - 1, y0 + y - 1)) {
+                    halo[y * HALO_STRIDE + (x >> 6)] |= Word(1) << (x & 63);
+                }
+            }
+        }
+        for (int y = 0; y < CHUNK; ++y) {
+            const Word* row = &halo[(y + 1) * HALO_STRIDE];
+            chunk.mines[y] = (row[0] >> 1) | (row[1] << 63);
+        }
+
+        uint8_t counts[HALO * HALO];
+        count_mines_bytes(halo, HALO, HALO, HALO_STRIDE, counts);
+        for (int y = 0; y < CHUNK; ++y) {
+            std::copy_n(&counts[(y + 1) * HALO + 1], CHUNK, &chunk.counts[y * CHUNK]);
+        }
+    }
+
+    ChunkWorld::Chunk& ChunkWorld::chunk(int64_t cx, int64_t cy) {
+        const uint64_t key = chunkKey(cx, cy);
+        auto it = m_chunks.find(key);
+        if (it != m_chunks.end()) {
+            m_lru.splice(m_lru.begin(), m_lru, it->second->lru);
+            return *it->second;
+        }
+
+        auto created = std::make_unique<Chunk>();
+        build(*created, cx, cy);
+        created->dirty = restore(key, *created);
+        m_lru.push_front(key);
+        created->lru = m_lru.begin();
+        return *m_chunks.emplace(key, std::move(created)).first->second;
+    }
+
+    bool ChunkWorld::restore(uint64_t key, Chunk& chunk) {
+        std::vector<uint8_t> data;
+        if (auto cold = m_cold.find(key); cold != m_cold.end()) {
+            data = std::move(cold->second.data);
+            m_cold_bytes -= data.size() + COLD_OVERHEAD;
+            m_cold.erase(cold);
+        } else if (auto spilled = m_spilled.find(key); spilled != m_spilled.end()) {
+            data.resize(spilled->second.size);
+            m_spill->stream.clear();
+            m_spill->stream.seekg(spilled->second.offset);
+            m_spill->stream.read(reinterpret_cast<char*>(data.data()), data.size());
+            m_spilled.erase(spilled);
+            if (!m_spill->stream) {
+                throw std::runtime_error("Failed to read spilled chunk");
+            }
+        } else {
+            return false;
+        }
+        Word words[CHUNK * 2];
+        if (!decode(data.data(), data.size(), words, CHUNK * 2)) {
+            throw std::runtime_error("Corrupted chunk data");
+        }
+        std::copy_n(words, CHUNK, chunk.revealed.begin());
+        std::copy_n(words + CHUNK, CHUNK, chunk.flags.begin());
+        return true;
+    }
+
+    void ChunkWorld::trim() {
+        while (m_chunks.size() > m_max_chunks) {
+            const uint64_t key = m_lru.back();
+            m_lru.pop_back();
+            auto it = m_chunks.find(key);
+            if (it->second->dirty) {
+                Word words[CHUNK * 2];
+                std::copy(it->second->revealed.begin(), it->second->revealed.end(), words);
+                std::copy(it->second->flags.begin(), it->second->flags.end(), words + CHUNK);
+                ColdChunk& cold = m_cold[key];
+                encode(words, CHUNK * 2, cold.data);
+                cold.data.shrink_to_fit();
+                cold.stamp = m_cold_stamp++;
+                m_cold_order.emplace_back(key, cold.stamp);
+                m_cold_bytes += cold.data.size() + COLD_OVERHEAD;
+            }
+            m_chunks.erase(it);
+        }
+        if (m_cold_bytes > m_cold_budget) {
+            spill();
+        }
+        // 区块反复进出时顺序表里会积累过期记录，定期清理
+        if (m_cold_order.size() > 2 * m_cold.size() + 64) {
+            std::erase_if(m_cold_order, [this](const auto& entry) {
+                auto it = m_cold.find(entry.first);
+                return it == m_cold.end() || it->second.stamp != entry.second;
+            });
+        }
+    }
+
+    void ChunkWorld::spill() {
+        if (!m_spill) {
+            m_spill = std::make_unique<SpillFile>();
+        }
+        // 无法创建临时文件时只能留在内存中
+        if (!m_spill->stream.is_open()) {
+            return;
+        }
+        while (m_cold_bytes > m_cold_budget && !m_cold_order.empty()) {
+            const auto [key, stamp] = m_cold_order.front();
+            m_cold_order.pop_front();
+            auto it = m_cold.find(key);
+            if (it == m_cold.end() || it->second.stamp != stamp) {
+                continue;
+            }
+            const auto& data = it->second.data;
+            m_spill->stream.clear();
+            m_spill->stream.seekp(m_spill->end);
+            m_spill->stream.write(reinterpret_cast<const char*>(data.data()), data.size());
+            if (!m_spill->stream) {
+                throw std::runtime_error("Failed to spill chunk");
+            }
+            m_spilled[key] = SpilledChunk{m_spill->end, static_cast<uint32_t>(data.size())};
+            m_spill->end += static_cast<int64_t>(data.size());
+            m_cold_bytes -= data.size() + COLD_OVERHEAD;
+            m_cold.erase(it);
+        }
+    }
+
+    bool ChunkWorld::isRevealed(int64_t x, int64_t y) {
+        bool result = (chunkAt(x, y).revealed[y & (CHUNK - 1)] >> (x & (CHUNK - 1))) & 1;
+        trim();
+        return result;
+    }
+
+    bool ChunkWorld::isFlagged(int64_t x, int64_t y) {
+        bool result = (chunkAt(x, y).flags[y & (CHUNK - 1)] >> (x & (CHUNK - 1))) & 1;
+        trim();
+        return result;
+    }
+
+    int ChunkWorld::getMineCount(int64_t x, int64_t y) {
+        int result = chunkAt(x, y).counts[(y & (CHUNK - 1)) * CHUNK + (x & (CHUNK - 1))];
+        trim();
+        return result;
+    }
+
+    CellState ChunkWorld::getState(int64_t x, int64_t y) {
+        if (!m_started) {
+            return CellState::Empty;
+        }
+        Chunk& c = chunkAt(x, y);
+        const Word bit = Word(1) << (x & (CHUNK - 1));
+        CellState state = CellState::Default;
+        if (c.revealed[y & (CHUNK - 1)] & bit) {
+            state = CellState::Uncovered;
+        } else if (c.flags[y & (CHUNK - 1)] & bit) {
+            state = CellState::Flag;
+        }
+        trim();
+        return state;
+    }
+
+    BoardResult ChunkWorld::leftClick(int64_t x, int64_t y) {
+        if (!m_started) {
+            m_started = true;
+            m_safe_x = x;
+            m_safe_y = y;
+            // 安全区改变了附近的雷，已加载的区块按新规则重建
+            for (auto& [key, c] : m_chunks) {
+                int64_t cx = static_cast<int32_t>(key >> 32), cy = static_cast<int32_t>(key);
+                build(*c, cx, cy);
+            }
+        }
+
+        Chunk& c = chunkAt(x, y);
+        Word& row = c.revealed[y & (CHUNK - 1)];
+        const Word bit = Word(1) << (x & (CHUNK - 1));
+        if ((row & bit) || (c.flags[y & (CHUNK - 1)] & bit)) {
+            return BoardResult::None;
+        }
+        row |= bit;
+        c.dirty = true;
+        if (c.mines[y & (CHUNK - 1)] & bit) {
+            return BoardResult::Lose;
+        }
+        m_uncovered += 1;
+        if (c.counts[(y & (CHUNK - 1)) * CHUNK + (x & (CHUNK - 1))] == 0) {
+            m_frontier.emplace_back(x, y);
+            revealStep(m_reveal_limit);
+        } else {
+            trim();
+        }
+        return BoardResult::None;
+    }
+
+    void ChunkWorld::rightClick(int64_t x, int64_t y) {
+        if (!m_started) {
+            return;
+        }
+        Chunk& c = chunkAt(x, y);
+        const Word bit = Word(1) << (x & (CHUNK - 1));
+        if (!(c.revealed[y & (CHUNK - 1)] & bit)) {
+            c.flags[y & (CHUNK - 1)] ^= bit;
+            c.dirty = true;
+        }
+        trim();
+    }
+
+    void ChunkWorld::revealStep(int64_t max_cells) {
+        // 队列里是已翻开的空白格，逐个展开它们的邻居；跨区块时只加载实际到达的区块
+        int64_t revealed = 0;
+        while (!m_frontier.empty() && revealed < max_cells) {
+            auto [x, y] = m_frontier.front();
+            m_frontier.pop_front();
+            for (int64_t ny = y - 1; ny <= y + 1; ++ny) {
+                for (int64_t nx = x - 1; nx <= x + 1; ++nx) {
+                    Chunk& c = chunkAt(nx, ny);
+                    Word& row = c.revealed[ny & (CHUNK - 1)];
+                    const Word bit = Word(1) << (nx & (CHUNK - 1));
+                    if ((row & bit) || (c.flags[ny & (CHUNK - 1)] & bit)) {
+                        continue;
+                    }
+                    row |= bit;
+                    c.dirty = true;
+                    m_uncovered += 1;
+                    revealed += 1;
+                    if (c.counts[(ny & (CHUNK - 1)) * CHUNK + (nx & (CHUNK - 1))] == 0) {
+                        m_frontier.emplace_back(nx, ny);
+                    }
+                }
+            }
+        }
+        trim();
+    }
+
+    void ChunkWorld::visit(int64_t left, int64_t top, int64_t right, int64_t bottom) {
+        for (int64_t cy = top >> CHUNK_SHIFT; cy <= bottom >> CHUNK_SHIFT; ++cy) {
+            for (int64_t cx = left >> CHUNK_SHIFT; cx <= right >> CHUNK_SHIFT; ++cx) {
+                chunk(cx, cy);
+            }
+        }
+        trim();
+    }
+
+    bool ChunkWorld::peek(int64_t x, int64_t y, CellState& state, int& mines) const {
+        auto it = m_chunks.find(chunkKey(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT));
+        if (it == m_chunks.end()) {
+            return false;
+        }
+        const Chunk& c = *it->second;
+        const Word bit = Word(1) << (x & (CHUNK - 1));
+        mines = c.counts[(y & (CHUNK - 1)) * CHUNK + (x & (CHUNK - 1))];
+        if (!m_started) {
+            state = CellState::Empty;
+        } else if (c.revealed[y & (CHUNK - 1)] & bit) {
+            state = CellState::Uncovered;
+        } else if (c.flags[y & (CHUNK - 1)] & bit) {
+            state = CellState::Flag;
+        } else {
+            state = CellState::Default;
+        }
+        return true;
+    }
+
+    void ChunkWorld::reset() {
+        m_chunks.clear();
+        m_cold.clear();
+        m_cold_order.clear();
+        m_cold_bytes = 0;
+        m_spilled.clear();
+        // 旧文件随之删除，下次需要写出时重新创建
+        m_spill.reset();
+        m_lru.clear();
+        m_frontier.clear();
+        m_started = false;
+        m_uncovered = 0;
+    }
+}
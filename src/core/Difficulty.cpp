@@ -0,0 +1,199 @@
+#include <Difficulty.hpp>
+#include <bit>
+#include <numeric>
+
+namespace Game {
+    BoardDifficulty DifficultyAnalyser::analyse(const uint64_t* mines, int width, int height, int stride) {
+        m_width = width;
+        m_height = height;
+        m_stride = stride;
+        // 零格：不是雷，3x3 内也没有雷
+        dilate(mines, m_near);
+        m_zeros.resize(m_near.size());
+        for (int y = 0; y < height; ++y) {
+            for (int k = 0; k < stride; ++k) {
+                const int i = y * stride + k;
+                m_zeros[i] = ~m_near[i] & validBits(k);
+            }
+        }
+        return count(mines, nullptr);
+    }
+
+    BoardDifficulty DifficultyAnalyser::analyse(const Board& board) {
+        if (!board.isGenerated()) {
+            return {};
+        }
+        m_width = board.getWidth();
+        m_height = board.getHeight();
+        m_stride = board.getStride();
+        m_zeros.assign(board.getZeroPlane().begin(), board.getZeroPlane().end());
+        // 布雷后各行都已是当前纪元，翻开平面可以直接使用
+        return count(board.getMinePlane().data(), board.getRevealedPlane().data());
+    }
+
+    BoardDifficulty DifficultyAnalyser::analyse(const Board& board, int px, int py) {
+        BoardDifficulty result = analyse(board);
+        if (!board.isGenerated() || !board.contains(px, py)) {
+            return result;
+        }
+        result.solvability = Solvability::NeedsGuess;
+        if (board.isMine(px, py)) {
+            return result;
+        }
+        if (!m_play || m_play->getWidth() != board.getWidth() || m_play->getHeight() != board.getHeight()) {
+            m_hints.reset();
+            m_play = std::make_unique<Board>(board.getWidth(), board.getHeight(), board.getCount());
+            m_hints = std::make_unique<HintEngine>(*m_play);
+        }
+        Board& play = *m_play;
+        HintEngine& hints = *m_hints;
+        play.loadMines(board.getMinePlane());
+        hints.update();
+        play.leftClick(px, py);
+        hints.update();
+        const int safe_cells = play.getWidth() * play.getHeight() - play.getCount();
+        while (play.getUncovered() > 0) {
+            const int safe = hints.nextSafe();
+            if (safe < 0) {
+                break;
+            }
+            play.leftClick(safe % play.getWidth(), safe / play.getWidth());
+            hints.update();
+        }
+        // 卡住时已推出的雷达到总数，其余未知格都安全
+        if (play.getUncovered() == 0 || static_cast<int>(hints.getMines().size()) == play.getCount()) {
+            result.solvability = Solvability::NoGuess;
+            result.solved_cells = safe_cells;
+        } else {
+            result.solved_cells = safe_cells - play.getUncovered();
+        }
+        return result;
+    }
+
+    BoardDifficulty DifficultyAnalyser::count(const uint64_t* mines, const uint64_t* revealed) {
+        // 孤立数字格：不是雷、不是零格，3x3 内也没有零格
+        dilate(m_zeros.data(), m_near);
+        m_isolated.resize(m_near.size());
+        int isolated = 0, solved_isolated = 0;
+        for (std::size_t i = 0; i < m_isolated.size(); ++i) {
+            m_isolated[i] = ~mines[i] & ~m_near[i] & validBits(static_cast<int>(i % m_stride));
+            isolated += std::popcount(m_isolated[i]);
+            if (revealed) {
+                solved_isolated += std::popcount(m_isolated[i] & revealed[i]);
+            }
+        }
+
+        BoardDifficulty result;
+        int solved_openings = 0, unused;
+        result.openings = components(m_zeros, revealed, solved_openings);
+        result.islands = components(m_isolated, nullptr, unused);
+        result.bbbv = result.openings + isolated;
+        result.solved_bbbv = solved_openings + solved_isolated;
+        return result;
+    }
+
+    int DifficultyAnalyser::components(const std::vector<uint64_t>& plane, const uint64_t* revealed, int& solved) {
+        // 每行的连续段，跨字的段在写入时接上
+        m_runs.clear();
+        m_row_runs.resize(m_height + 1);
+        for (int y = 0; y < m_height; ++y) {
+            const int first = static_cast<int>(m_runs.size());
+            m_row_runs[y] = first;
+            for (int k = 0; k < m_stride; ++k) {
+                uint64_t bits = plane[y * m_stride + k];
+                while (bits) {
+                    const int start = std::countr_zero(bits);
+                    const int length = std::countr_one(bits >> start);
+                    const int x0 = k * 64 + start, x1 = x0 + length - 1;
+                    if (static_cast<int>(m_runs.size()) > first && m_runs.back().x1 + 1 == x0) {
+                        m_runs.back().x1 = x1;
+                    } else {
+                        m_runs.push_back({x0, x1});
+                    }
+                    if (start + length == 64) {
+                        break;
+                    }
+                    bits &= ~uint64_t(0) << (start + length);
+                }
+            }
+        }
+        m_row_runs[m_height] = static_cast<int>(m_runs.size());
+
+        // 并查集，根总是连通块中最小的下标
+        const int runs = static_cast<int>(m_runs.size());
+        m_parent.resize(runs);
+        std::iota(m_parent.begin(), m_parent.end(), 0);
+        auto find = [this](int a) {
+            while (m_parent[a] != a) {
+                m_parent[a] = m_parent[m_parent[a]];
+                a = m_parent[a];
+            }
+            return a;
+        };
+        int groups = runs;
+        for (int y = 1; y < m_height; ++y) {
+            // 与上一行的段在横向扩展一格后重叠即 8 邻接，两行的段都按 x 升序，双指针扫描
+            int j = m_row_runs[y - 1];
+            const int end = m_row_runs[y];
+            for (int i = m_row_runs[y]; i < m_row_runs[y + 1]; ++i) {
+                while (j < end && m_runs[j].x1 < m_runs[i].x0 - 1) {
+                    ++j;
+                }
+                for (int t = j; t < end && m_runs[t].x0 <= m_runs[i].x1 + 1; ++t) {
+                    int a = find(i), b = find(t);
+                    if (a != b) {
+                        if (a < b) m_parent[b] = a; else m_parent[a] = b;
+                        groups -= 1;
+                    }
+                }
+            }
+        }
+
+        solved = 0;
+        if (revealed) {
+            m_solved.assign(runs, 0);
+            for (int y = 0; y < m_height; ++y) {
+                for (int r = m_row_runs[y]; r < m_row_runs[y + 1]; ++r) {
+                    const Run& run = m_runs[r];
+                    bool any = false;
+                    for (int k = run.x0 / 64; k <= run.x1 / 64 && !any; ++k) {
+                        uint64_t mask = ~uint64_t(0);
+                        if (k == run.x0 / 64) mask &= ~uint64_t(0) << (run.x0 % 64);
+                        if (k == run.x1 / 64) mask &= ~uint64_t(0) >> (63 - run.x1 % 64);
+                        any = revealed[y * m_stride + k] & mask;
+                    }
+                    if (any) {
+                        uint8_t& flag = m_solved[find(r)];
+                        solved += !flag;
+                        flag = 1;
+                    }
+                }
+            }
+        }
+        return groups;
+    }
+
+    void DifficultyAnalyser::dilate(const uint64_t* plane, std::vector<uint64_t>& out) {
+        // 先横向：每个字左右各移一位，跨字的位从相邻字补上
+        m_row.resize(static_cast<std::size_t>(m_height) * m_stride);
+        for (int y = 0; y < m_height; ++y) {
+            const uint64_t* row = plane + y * m_stride;
+            for (int k = 0; k < m_stride; ++k) {
+                uint64_t word = row[k] | row[k] << 1 | row[k] >> 1;
+                if (k > 0) word |= row[k - 1] >> 63;
+                if (k + 1 < m_stride) word |= row[k + 1] << 63;
+                m_row[y * m_stride + k] = word;
+            }
+        }
+        // 再纵向
+        out.resize(m_row.size());
+        for (int y = 0; y < m_height; ++y) {
+            for (int k = 0; k < m_stride; ++k) {
+                uint64_t word = m_row[y * m_stride + k];
+                if (y > 0) word |= m_row[(y - 1) * m_stride + k];
+                if (y + 1 < m_height) word |= m_row[(y + 1) * m_stride + k];
+                out[y * m_stride + k] = word;
+            }
+        }
+    }
+}
@@ -0,0 +1,14 @@
+#include <FixedBoard.hpp>
+
+namespace Game {
+    AnyBoard make_board(int w, int h, int count) {
+        if (w == BeginnerBoard::WIDTH && h == BeginnerBoard::HEIGHT && count == BeginnerBoard::MINES) {
+            return AnyBoard(std::in_place_type<BeginnerBoard>);
+        } else if (w == IntermediateBoard::WIDTH && h == IntermediateBoard::HEIGHT && count == IntermediateBoard::MINES) {
+            return AnyBoard(std::in_place_type<IntermediateBoard>);
+        } else if (w == ExpertBoard::WIDTH && h == ExpertBoard::HEIGHT && count == ExpertBoard::MINES) {
+            return AnyBoard(std::in_place_type<ExpertBoard>);
+        }
+        return AnyBoard(std::in_place_type<Board>, w, h, count);
+    }
+}
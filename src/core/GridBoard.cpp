@@ -0,0 +1,173 @@
+#include <GridBoard.hpp>
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+
+namespace Game {
+    template <typename Topology>
+    GridBoard<Topology>::GridBoard(int w, int h, int d, int count)
+        : m_width(w), m_height(h), m_depth(d), m_count(count)
+    {
+        if (w <= 0 || h <= 0 || d <= 0 || (!Topology::DEPTH && d != 1)) {
+            throw std::invalid_argument("Invalid dimensions");
+        }
+        if (Topology::WRAP && (w < 3 || h < 3)) {
+            throw std::invalid_argument("Wrapped boards need at least 3 cells per side");
+        }
+        if (count <= 0 || count > w * h * d - (Topology::DEGREE + 1)) {
+            throw std::invalid_argument("Invalid mine count");
+        }
+        m_cells.resize(static_cast<size_t>(w) * h * d);
+        m_counts.resize(m_cells.size());
+        reset();
+    }
+
+    template <typename Topology>
+    CellState GridBoard<Topology>::getState(int x, int y, int z) const {
+        const uint8_t cell = m_cells[index(x, y, z)];
+        if (cell & REVEALED) {
+            return CellState::Uncovered;
+        } else if (cell & FLAG) {
+            return CellState::Flag;
+        }
+        return m_generated ? CellState::Default : CellState::Empty;
+    }
+
+    template <typename Topology>
+    void GridBoard<Topology>::generate(int px, int py, int pz, RandomRef random) {
+        // 安全区是点击格和它的邻居，排序后用于把抽到的名次映射到格子
+        std::vector<int> safe = {index(px, py, pz)};
+        forEachNeighbour(safe.front(), [&safe](int n) { safe.push_back(n); });
+        std::sort(safe.begin(), safe.end());
+        auto cell_of = [&safe](int r) {
+            for (int s : safe) {
+                if (s <= r) ++r;
+            }
+            return r;
+        };
+
+        for (auto& cell : m_cells) cell &= ~MINE;
+        const int n = static_cast<int>(m_cells.size() - safe.size());
+        for (int j = n - m_count; j < n; ++j) {
+            int i = cell_of(static_cast<int>(random.below(j + 1)));
+            if (m_cells[i] & MINE) {
+                i = cell_of(j);
+            }
+            m_cells[i] |= MINE;
+        }
+
+        std::fill(m_counts.begin(), m_counts.end(), 0);
+        m_flag_mine_count = 0;
+        for (int i = 0; i < static_cast<int>(m_cells.size()); ++i) {
+            if (m_cells[i] & MINE) {
+                forEachNeighbour(i, [this](int n) { ++m_counts[n]; });
+                m_flag_mine_count += (m_cells[i] & FLAG) != 0;
+            }
+        }
+        m_generated = true;
+    }
+
+    template <typename Topology>
+    void GridBoard<Topology>::reset() {
+        std::fill(m_cells.begin(), m_cells.end(), 0);
+        std::fill(m_counts.begin(), m_counts.end(), 0);
+        m_uncovered = static_cast<int>(m_cells.size()) - m_count;
+        m_flag_mine_count = 0;
+        m_generated = false;
+    }
+
+    template <typename Topology>
+    void GridBoard<Topology>::flood(int start) {
+        m_stack.clear();
+        m_stack.push_back(start);
+        while (!m_stack.empty()) {
+            int i = m_stack.back();
+            m_stack.pop_back();
+            forEachNeighbour(i, [this](int n) {
+                if (m_cells[n] & (REVEALED | FLAG | MINE)) {
+                    return;
+                }
+                m_cells[n] |= REVEALED;
+                --m_uncovered;
+                if (m_counts[n] == 0) {
+                    m_stack.push_back(n);
+                }
+            });
+        }
+    }
+
+    template <typename Topology>
+    BoardResult GridBoard<Topology>::leftClick(int x, int y, int z) {
+        const int i = index(x, y, z);
+        if (m_cells[i] & (REVEALED | FLAG)) {
+            return BoardResult::None;
+        }
+        if (!m_generated) {
+            thread_local SplitMix64 seeds(
+                (uint64_t(std::random_device{}()) << 32) ^ std::random_device{}());
+            Xoshiro256 engine(seeds());
+            generate(x, y, z, engine);
+        }
+        m_cells[i] |= REVEALED;
+        if (m_cells[i] & MINE) {
+            return BoardResult::Lose;
+        }
+        --m_uncovered;
+        if (m_counts[i] == 0) {
+            flood(i);
+        }
+        return m_uncovered == 0 ? BoardResult::Win : BoardResult::None;
+    }
+
+    template <typename Topology>
+    BoardResult GridBoard<Topology>::rightClick(int x, int y, int z) {
+        uint8_t& cell = m_cells[index(x, y, z)];
+        if (cell & REVEALED) {
+            return BoardResult::None;
+        }
+        cell ^= FLAG;
+        const int on_mine = m_generated && (cell & MINE);
+        if (!(cell & FLAG)) {
+            m_flag_mine_count -= on_mine;
+            return BoardResult::None;
+        }
+        m_flag_mine_count += on_mine;
+        return m_flag_mine_count == m_count ? BoardResult::Win : BoardResult::None;
+    }
+
+    template <typename Topology>
+    BoardResult GridBoard<Topology>::chord(int x, int y, int z) {
+        const int i = index(x, y, z);
+        if (!m_generated || (m_cells[i] & (REVEALED | MINE)) != REVEALED || m_counts[i] == 0) {
+            return BoardResult::None;
+        }
+        int flags = 0;
+        forEachNeighbour(i, [this, &flags](int n) { flags += (m_cells[n] & FLAG) != 0; });
+        if (flags != m_counts[i]) {
+            return BoardResult::None;
+        }
+        bool lost = false;
+        forEachNeighbour(i, [this, &lost](int n) {
+            if (m_cells[n] & (REVEALED | FLAG)) {
+                return;
+            }
+            m_cells[n] |= REVEALED;
+            if (m_cells[n] & MINE) {
+                lost = true;
+                return;
+            }
+            --m_uncovered;
+            if (m_counts[n] == 0) {
+                flood(n);
+            }
+        });
+        if (lost) {
+            return BoardResult::Lose;
+        }
+        return m_uncovered == 0 ? BoardResult::Win : BoardResult::None;
+    }
+
+    template class GridBoard<Topology::Hex6>;
+    template class GridBoard<Topology::Torus8>;
+    template class GridBoard<Topology::Cube26>;
+}
@@ -0,0 +1,70 @@
+#include <HintEngine.hpp>
+#include <algorithm>
+
+namespace Game {
+    void HintEngine::update(int max_steps) {
+        const auto changes = m_board.getChanges();
+        const bool rebuild = std::any_of(changes.begin(), changes.end(),
+            [](const CellChange& c) { return c.index == CellChange::ALL_CELLS; });
+        if (rebuild) {
+            // 整盘变化之后的记录已反映在棋盘上，一并重建
+            m_safe.clear();
+            m_mines.clear();
+            m_mines_dirty = false;
+            // 重建同样受步数限制，没处理完的约束留在 Solver 的队列里由 settle 继续
+            m_settled = m_solver.solve(m_board, max_steps);
+            collect();
+            return;
+        }
+        if (!m_board.isGenerated()) {
+            return;
+        }
+        const int width = m_board.getWidth();
+        m_covered.clear();
+        for (const CellChange& c : changes) {
+            if (c.after == CellState::Uncovered && c.before != CellState::Uncovered) {
+                m_solver.reveal(m_board, c.index % width, c.index / width);
+                m_mines_dirty |= m_board.isMine(c.index % width, c.index / width);
+            } else if (c.before == CellState::Uncovered && c.after != CellState::Uncovered) {
+                m_covered.push_back(c.index);
+            }
+        }
+        if (!m_covered.empty()) {
+            m_solver.cover(m_board, m_covered);
+            m_mines_dirty = true;
+        }
+        settle(max_steps);
+    }
+
+    bool HintEngine::settle(int max_steps) {
+        m_settled = m_solver.settle(max_steps);
+        collect();
+        return m_settled;
+    }
+
+    void HintEngine::collect() {
+        m_safe.insert(m_safe.end(), m_solver.getSafe().begin(), m_solver.getSafe().end());
+        m_mines.insert(m_mines.end(), m_solver.getMines().begin(), m_solver.getMines().end());
+        m_solver.clearResults();
+    }
+
+    int HintEngine::nextSafe() {
+        const int width = m_board.getWidth();
+        while (!m_safe.empty() && !isSafe(m_safe.back() % width, m_safe.back() / width)) {
+            m_safe.pop_back();
+        }
+        return m_safe.empty() ? -1 : m_safe.back();
+    }
+
+    std::span<const int> HintEngine::getMines() {
+        // 只在撤销或踩雷之后整理；撤销后同一格可能被再次推出，去掉失效和重复的
+        if (m_mines_dirty) {
+            const int width = m_board.getWidth();
+            std::erase_if(m_mines, [&](int i) { return !isMine(i % width, i / width); });
+            std::sort(m_mines.begin(), m_mines.end());
+            m_mines.erase(std::unique(m_mines.begin(), m_mines.end()), m_mines.end());
+            m_mines_dirty = false;
+        }
+        return m_mines;
+    }
+}
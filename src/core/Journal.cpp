@@ -0,0 +1,113 @@
+#include <Journal.hpp>
+#include <algorithm>
+
+namespace Game {
+    Journal::Journal(std::size_t memory_cap) : m_memory_cap(memory_cap) {}
+
+    void Journal::append(const CellChange& change) {
+        const auto before = static_cast<uint32_t>(change.before);
+        const auto after = static_cast<uint32_t>(change.after);
+        if (m_open > 0) {
+            Run& last = m_runs.back();
+            if (last.before == before && last.after == after && last.length < MAX_RUN
+                && last.start + last.length == static_cast<uint32_t>(change.index)) {
+                last.length += 1;
+                return;
+            }
+        }
+        m_runs.push_back({static_cast<uint32_t>(change.index), 1, before, after});
+        m_open += 1;
+    }
+
+    void Journal::record(std::span<const CellChange> changes) {
+        for (const CellChange& change : changes) {
+            if (change.index == CellChange::ALL_CELLS) {
+                clear();
+                m_discard = true;
+            } else if (!m_discard) {
+                append(change);
+            }
+        }
+    }
+
+    void Journal::commit() {
+        m_discard = false;
+        if (m_open == 0) {
+            return;
+        }
+        m_actions.push_back(m_open);
+        m_open = 0;
+        m_redo_runs.clear();
+        m_redo_actions.clear();
+        trim();
+    }
+
+    void Journal::clear() {
+        m_runs.clear();
+        m_actions.clear();
+        m_open = 0;
+        m_discard = false;
+        m_redo_runs.clear();
+        m_redo_actions.clear();
+    }
+
+    bool Journal::undo(Board& board) {
+        if (!canUndo() || board.isRevealing()) {
+            return false;
+        }
+        const std::size_t runs = m_actions.back();
+        m_actions.pop_back();
+        const auto first = m_runs.end() - static_cast<std::ptrdiff_t>(runs);
+        const int width = board.getWidth();
+        // 同一格在一次操作中可能变化多次（分帧翻开先排队再翻开），逆序恢复
+        board.batch([&] {
+            for (auto it = m_runs.end(); it != first;) {
+                --it;
+                for (uint32_t i = it->start + it->length; i-- > it->start;) {
+                    board.setState(static_cast<int>(i % width), static_cast<int>(i / width), static_cast<CellState>(it->before));
+                }
+            }
+        });
+        m_redo_runs.insert(m_redo_runs.end(), first, m_runs.end());
+        m_redo_actions.push_back(runs);
+        m_runs.erase(first, m_runs.end());
+        return true;
+    }
+
+    bool Journal::redo(Board& board) {
+        if (!canRedo() || board.isRevealing()) {
+            return false;
+        }
+        const std::size_t runs = m_redo_actions.back();
+        m_redo_actions.pop_back();
+        const auto first = m_redo_runs.end() - static_cast<std::ptrdiff_t>(runs);
+        const int width = board.getWidth();
+        board.batch([&] {
+            for (auto it = first; it != m_redo_runs.end(); ++it) {
+                for (uint32_t i = it->start; i < it->start + it->length; ++i) {
+                    board.setState(static_cast<int>(i % width), static_cast<int>(i / width), static_cast<CellState>(it->after));
+                }
+            }
+        });
+        m_runs.insert(m_runs.end(), first, m_redo_runs.end());
+        m_actions.push_back(runs);
+        m_redo_runs.erase(first, m_redo_runs.end());
+        return true;
+    }
+
+    void Journal::setMemoryCap(std::size_t memory_cap) {
+        m_memory_cap = memory_cap;
+        trim();
+    }
+
+    void Journal::trim() {
+        while (getMemory() > m_memory_cap && m_actions.size() > 1) {
+            m_runs.erase(m_runs.begin(), m_runs.begin() + static_cast<std::ptrdiff_t>(m_actions.front()));
+            m_actions.pop_front();
+        }
+        if (getMemory() > m_memory_cap) {
+            m_redo_runs.clear();
+            m_redo_actions.clear();
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#include <LayoutPool.hpp>
+#include <random>
+#include <stdexcept>
+
+namespace Game {
+    LayoutPool::LayoutPool(int w, int h, int count, std::size_t capacity)
+        : m_width(w), m_height(h), m_count(count), m_capacity(capacity)
+    {
+        m_worker = std::thread([this] { run(); });
+    }
+
+    LayoutPool::~LayoutPool() {
+        {
+            std::lock_guard lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_one();
+        m_worker.join();
+    }
+
+    std::optional<Board> LayoutPool::take() {
+        std::optional<Board> layout;
+        {
+            std::lock_guard lock(m_mutex);
+            if (m_ready.empty()) {
+                return std::nullopt;
+            }
+            layout.emplace(std::move(m_ready.front()));
+            m_ready.pop_front();
+        }
+        m_wake.notify_one();
+        return layout;
+    }
+
+    void LayoutPool::refill() {
+        m_wake.notify_one();
+    }
+
+    std::size_t LayoutPool::getReady() {
+        std::lock_guard lock(m_mutex);
+        return m_ready.size();
+    }
+
+    void LayoutPool::run() {
+        SplitMix64 random((uint64_t(std::random_device{}()) << 32) ^ std::random_device{}());
+        RandomRef pick(random);
+        std::unique_lock lock(m_mutex);
+        while (true) {
+            m_wake.wait(lock, [this] { return m_stop || (!m_failed && m_ready.size() < m_capacity); });
+            if (m_stop) {
+                return;
+            }
+            lock.unlock();
+            // 安全区放在随机位置，首次点击时再移到真正的点击处
+            std::optional<Board> layout;
+            try {
+                layout.emplace(m_width, m_height, m_count);
+                layout->generate(static_cast<int>(pick.below(m_width)), static_cast<int>(pick.below(m_height)));
+            } catch (const std::invalid_argument&) {
+                layout.reset();
+            }
+            lock.lock();
+            if (layout) {
+                m_ready.push_back(std::move(*layout));
+            } else {
+                m_failed = true;
+            }
+        }
+    }
+}
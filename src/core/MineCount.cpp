@@ -0,0 +1,191 @@
+#include <MineCount.hpp>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define MINE_COUNT_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MINE_COUNT_SSE2
+#endif
+
+namespace {
+    // 每个字节展开为 8 个 0/1 字节
+    constexpr std::array<uint64_t, 256> make_expand_table() {
+        std::array<uint64_t, 256> table{};
+        for (int b = 0; b < 256; ++b) {
+            for (int j = 0; j < 8; ++j) {
+                table[b] |= uint64_t((b >> j) & 1) << (8 * j);
+            }
+        }
+        return table;
+    }
+    constexpr auto EXPAND = make_expand_table();
+
+    // 缓冲区两端留出的字节，允许向量错位读写越界
+    constexpr int PAD = 32;
+
+    void expand_row(const uint64_t* row, int stride, uint8_t* out) {
+        for (int k = 0; k < stride; ++k) {
+            uint64_t word = row[k];
+            for (int j = 0; j < 8; ++j) {
+                std::memcpy(out + k * 64 + j * 8, &EXPAND[(word >> (8 * j)) & 0xFF], 8);
+            }
+        }
+    }
+
+    // v = up + mid + down
+    void sum_rows(const uint8_t* up, const uint8_t* mid, const uint8_t* down, uint8_t* v, int n) {
+        int i = 0;
+#if defined(MINE_COUNT_AVX2)
+        for (; i + 32 <= n; i += 32) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(up + i));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mid + i));
+            __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(down + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(v + i), _mm256_add_epi8(_mm256_add_epi8(a, b), c));
+        }
+#elif defined(MINE_COUNT_SSE2)
+        for (; i + 16 <= n; i += 16) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(up + i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mid + i));
+            __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(down + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(v + i), _mm_add_epi8(_mm_add_epi8(a, b), c));
+        }
+#endif
+        for (; i < n; ++i) {
+            v[i] = up[i] + mid[i] + down[i];
+        }
+    }
+
+    // c[i] = v[i-1] + v[i] + v[i+1] - mid[i]，v[-1] 与 v[n] 为 0
+    void box_row(const uint8_t* v, const uint8_t* mid, uint8_t* c, int n) {
+        int i = 0;
+#if defined(MINE_COUNT_AVX2)
+        for (; i + 32 <= n; i += 32) {
+            __m256i l = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + i - 1));
+            __m256i m = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + i));
+            __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + i + 1));
+            __m256i self = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mid + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(c + i), _mm256_sub_epi8(_mm256_add_epi8(_mm256_add_epi8(l, m), r), self));
+        }
+#elif defined(MINE_COUNT_SSE2)
+        for (; i + 16 <= n; i += 16) {
+            __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + i - 1));
+            __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + i));
+            __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + i + 1));
+            __m128i self = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mid + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(c + i), _mm_sub_epi8(_mm_add_epi8(_mm_add_epi8(l, m), r), self));
+        }
+#endif
+        for (; i < n; ++i) {
+            c[i] = v[i - 1] + v[i] + v[i + 1] - mid[i];
+        }
+    }
+
+    // 64 个计数中为 0 的位置
+    uint64_t zero_mask(const uint8_t* c) {
+#if defined(MINE_COUNT_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        uint64_t mask = 0;
+        for (int j = 0; j < 4; ++j) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c + j * 16));
+            mask |= uint64_t(uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(x, zero)))) << (16 * j);
+        }
+        return mask;
+#else
+        uint64_t mask = 0;
+        for (int j = 0; j < 64; ++j) {
+            mask |= uint64_t(c[j] == 0) << j;
+        }
+        return mask;
+#endif
+    }
+
+    // 把 n 个计数打包写入全局下标 start 起的 4 位数组
+    void pack_nibbles(const uint8_t* c, int n, uint8_t* nibbles, int64_t start) {
+        if (n > 0 && (start & 1)) {
+            nibbles[start >> 1] = uint8_t((nibbles[start >> 1] & 0x0F) | (c[0] << 4));
+            ++c;
+            --n;
+            ++start;
+        }
+        uint8_t* out = nibbles + (start >> 1);
+        int i = 0;
+#if defined(MINE_COUNT_SSE2)
+        // 16 位通道 [偶, 奇] -> 偶 | 奇 << 4
+        const __m128i low = _mm_set1_epi16(0x00FF);
+        for (; i + 16 <= n; i += 16) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c + i));
+            x = _mm_and_si128(_mm_or_si128(x, _mm_srli_epi16(x, 4)), low);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i / 2), _mm_packus_epi16(x, x));
+        }
+#endif
+        for (; i + 2 <= n; i += 2) {
+            out[i / 2] = uint8_t(c[i] | (c[i + 1] << 4));
+        }
+        if (i < n) {
+            out[i / 2] = c[i];
+        }
+    }
+
+    // 逐行计算，每行结果交给 emit(y, counts)
+    template <typename Emit>
+    void for_each_count_row(const uint64_t* mines, int width, int height, int stride, Emit&& emit) {
+        const int padded = stride * 64;
+        const int row_size = padded + 2 * PAD;
+        // 上、中、下三行展开、纵向和、结果各一行，按线程复用
+        static thread_local std::vector<uint8_t> buffer;
+        buffer.assign(static_cast<size_t>(row_size) * 6, 0);
+        uint8_t* rows[3] = {
+            buffer.data() + PAD,
+            buffer.data() + row_size + PAD,
+            buffer.data() + 2 * row_size + PAD,
+        };
+        uint8_t* empty = buffer.data() + 3 * row_size + PAD;
+        uint8_t* v = buffer.data() + 4 * row_size + PAD;
+        uint8_t* c = buffer.data() + 5 * row_size + PAD;
+
+        expand_row(mines, stride, rows[1]);
+        for (int y = 0; y < height; ++y) {
+            const uint8_t* up = y > 0 ? rows[0] : empty;
+            const uint8_t* mid = rows[1];
+            const uint8_t* down = empty;
+            if (y + 1 < height) {
+                expand_row(mines + (y + 1) * stride, stride, rows[2]);
+                down = rows[2];
+            }
+            sum_rows(up, mid, down, v, width);
+            // 第 width 列之后展开值为 0，纵向和也为 0
+            v[width] = 0;
+            box_row(v, mid, c, width);
+            emit(y, c);
+            std::rotate(rows, rows + 1, rows + 3);
+        }
+    }
+}
+
+namespace Game {
+    void count_mines(const uint64_t* mines, int width, int height, int stride, uint8_t* nibbles, uint64_t* zeros) {
+        const uint64_t tail = (width % 64) ? (uint64_t(1) << (width % 64)) - 1 : ~uint64_t(0);
+        for_each_count_row(mines, width, height, stride, [&](int y, uint8_t* c) {
+            pack_nibbles(c, width, nibbles, int64_t(y) * width);
+            if (zeros) {
+                // 宽度之外的计数不可信，由 tail 屏蔽
+                for (int k = 0; k < stride; ++k) {
+                    uint64_t mask = zero_mask(c + k * 64) & ~mines[y * stride + k];
+                    zeros[y * stride + k] = k + 1 == stride ? mask & tail : mask;
+                }
+            }
+        });
+    }
+
+    void count_mines_bytes(const uint64_t* mines, int width, int height, int stride, uint8_t* out) {
+        for_each_count_row(mines, width, height, stride, [&](int y, uint8_t* c) {
+            std::memcpy(out + int64_t(y) * width, c, width);
+        });
+    }
+}
@@ -0,0 +1,150 @@
+#include <NoGuess.hpp>
+#include <HintEngine.hpp>
+#include <Random.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace Game {
+    namespace {
+        struct Search {
+            int px, py;
+            std::chrono::steady_clock::time_point deadline;
+            std::stop_token stop;
+            std::atomic<bool> done = false;
+            std::mutex mutex;
+            std::vector<Board::Word> mines;
+        };
+
+        // 从首次点击开始只翻开可证明安全的格子，能翻完返回 true
+        bool play(Board& board, HintEngine& hints, const Search& search) {
+            board.leftClick(search.px, search.py);
+            hints.update();
+            while (board.getUncovered() > 0) {
+                if (search.done.load(std::memory_order_relaxed) || search.stop.stop_requested()) {
+                    return false;
+                }
+                int safe = hints.nextSafe();
+                if (safe < 0) {
+                    // 已推出的雷达到总数时，其余未知格都安全
+                    return static_cast<int>(hints.getMines().size()) == board.getCount();
+                }
+                board.leftClick(safe % board.getWidth(), safe / board.getWidth());
+                hints.update();
+            }
+            return true;
+        }
+
+        // 卡住时随机选一个未知的边界格，把它周围 3x3 内的一个雷移到不与已翻开格相邻的位置
+        bool repair(Board& board, HintEngine& hints, const Search& search, Xoshiro256& random, std::vector<Board::Word>& mines) {
+            const int w = board.getWidth(), h = board.getHeight(), stride = board.getStride();
+            auto touches_revealed = [&](int x, int y) {
+                bool touches = false;
+                board.forEachNeighbour(x, y, [&](int nx, int ny) { touches |= board.isRevealed(nx, ny); });
+                return touches;
+            };
+            std::vector<int> frontier, targets;
+            for (int y = 0; y < h; ++y) {
+                for (int x = 0; x < w; ++x) {
+                    if (board.isRevealed(x, y)) {
+                        continue;
+                    }
+                    if (touches_revealed(x, y)) {
+                        if (!hints.isSafe(x, y) && !hints.isMine(x, y)) frontier.push_back(y * w + x);
+                    } else if (!board.isMine(x, y) && (std::abs(x - search.px) > 1 || std::abs(y - search.py) > 1)) {
+                        targets.push_back(y * w + x);
+                    }
+                }
+            }
+            if (frontier.empty() || targets.empty()) {
+                return false;
+            }
+            RandomRef pick(random);
+            const int u = frontier[pick.below(frontier.size())];
+            std::vector<int> sources;
+            auto add_source = [&](int x, int y) {
+                if (board.isMine(x, y) && !board.isRevealed(x, y) && !hints.isMine(x, y)) sources.push_back(y * w + x);
+            };
+            add_source(u % w, u / w);
+            board.forEachNeighbour(u % w, u / w, add_source);
+            if (sources.empty()) {
+                return false;
+            }
+            const int from = sources[pick.below(sources.size())];
+            const int to = targets[pick.below(targets.size())];
+            mines.assign(board.getMinePlane().begin(), board.getMinePlane().end());
+            mines[(from / w) * stride + (from % w) / Board::WORD_BITS] &= ~(Board::Word(1) << (from % w % Board::WORD_BITS));
+            mines[(to / w) * stride + (to % w) / Board::WORD_BITS] |= Board::Word(1) << (to % w % Board::WORD_BITS);
+            board.loadMines(mines);
+            hints.update();
+            return true;
+        }
+
+        void work(int w, int h, int count, Search& search, const NoGuessOptions& options, uint64_t seed) {
+            Xoshiro256 random(seed);
+            Board board(w, h, count);
+            HintEngine hints(board);
+            std::vector<Board::Word> mines;
+            while (!search.done.load(std::memory_order_relaxed)) {
+                if (std::chrono::steady_clock::now() > search.deadline || search.stop.stop_requested()) {
+                    search.done = true;
+                    return;
+                }
+                board.reset();
+                board.generate(search.px, search.py, random);
+                hints.update();
+                for (int attempt = 0; attempt <= options.repairs; ++attempt) {
+                    if (play(board, hints, search)) {
+                        std::lock_guard lock(search.mutex);
+                        if (!search.done.exchange(true)) {
+                            search.mines.assign(board.getMinePlane().begin(), board.getMinePlane().end());
+                        }
+                        return;
+                    }
+                    if (search.done.load(std::memory_order_relaxed) || attempt == options.repairs
+                        || !repair(board, hints, search, random, mines)) {
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    std::optional<Board> make_no_guess_board(int w, int h, int count, int px, int py, const NoGuessOptions& options) {
+        Board result(w, h, count);
+        if (!result.contains(px, py)) {
+            throw std::invalid_argument("First click outside the board");
+        }
+        // 提前检查雷数，避免在工作线程中抛出
+        result.generate(px, py);
+
+        Search search;
+        search.px = px;
+        search.py = py;
+        search.deadline = std::chrono::steady_clock::now() + options.timeout;
+        search.stop = options.stop;
+        int workers = options.workers > 0 ? options.workers : static_cast<int>(std::thread::hardware_concurrency());
+        workers = std::max(workers, 1);
+        SplitMix64 seeds((uint64_t(std::random_device{}()) << 32) ^ std::random_device{}());
+
+        std::vector<std::thread> threads;
+        threads.reserve(workers - 1);
+        for (int i = 1; i < workers; ++i) {
+            threads.emplace_back(work, w, h, count, std::ref(search), std::cref(options), seeds());
+        }
+        work(w, h, count, search, options, seeds());
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        if (search.mines.empty()) {
+            return std::nullopt;
+        }
+        result.loadMines(search.mines);
+        return result;
+    }
+}
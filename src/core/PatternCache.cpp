@@ -0,0 +1,107 @@
+#include <PatternCache.hpp>
+#include <bit>
+#include <istream>
+#include <ostream>
+
+namespace Game {
+    namespace {
+        // 按小端序读写，保存的文件与平台无关
+        void put(std::ostream& out, uint64_t value, int bytes) {
+            for (int i = 0; i < bytes; ++i) {
+                out.put(static_cast<char>(value >> (i * 8)));
+            }
+        }
+
+        bool get(std::istream& in, uint64_t& value, int bytes) {
+            value = 0;
+            for (int i = 0; i < bytes; ++i) {
+                int c = in.get();
+                if (c == std::istream::traits_type::eof()) return false;
+                value |= uint64_t(static_cast<unsigned char>(c)) << (i * 8);
+            }
+            return true;
+        }
+    }
+
+    PatternCache::PatternCache(std::size_t entries) {
+        const std::size_t size = std::bit_ceil(entries < 1 ? std::size_t(1) : entries);
+        m_entries = std::make_unique<Entry[]>(size);
+        m_mask = size - 1;
+    }
+
+    std::optional<PatternCache::Result> PatternCache::find(uint64_t key) {
+        const Entry& entry = m_entries[key & m_mask];
+        const Result result{entry.mines.load(std::memory_order_relaxed), entry.safe.load(std::memory_order_relaxed)};
+        // 空条目相当于 "键 0 无结论"，即使误中也不会得出错误的推理
+        if (entry.check.load(std::memory_order_relaxed) != checkOf(key, result)) {
+            m_misses.fetch_add(1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+        m_hits.fetch_add(1, std::memory_order_relaxed);
+        return result;
+    }
+
+    void PatternCache::store(uint64_t key, Result result) {
+        Entry& entry = m_entries[key & m_mask];
+        entry.mines.store(result.mines, std::memory_order_relaxed);
+        entry.safe.store(result.safe, std::memory_order_relaxed);
+        entry.check.store(checkOf(key, result), std::memory_order_relaxed);
+    }
+
+    void PatternCache::clear() {
+        for (std::size_t i = 0; i <= m_mask; ++i) {
+            m_entries[i].check.store(0, std::memory_order_relaxed);
+            m_entries[i].mines.store(0, std::memory_order_relaxed);
+            m_entries[i].safe.store(0, std::memory_order_relaxed);
+        }
+        resetCounters();
+    }
+
+    void PatternCache::resetCounters() {
+        m_hits.store(0, std::memory_order_relaxed);
+        m_misses.store(0, std::memory_order_relaxed);
+    }
+
+    bool PatternCache::save(std::ostream& out) const {
+        put(out, MAGIC, 4);
+        put(out, FORMAT, 4);
+        for (std::size_t i = 0; i <= m_mask; ++i) {
+            const Entry& entry = m_entries[i];
+            const uint64_t check = entry.check.load(std::memory_order_relaxed);
+            const Result result{entry.mines.load(std::memory_order_relaxed), entry.safe.load(std::memory_order_relaxed)};
+            if (check == 0 && result.mines == 0 && result.safe == 0) {
+                continue;
+            }
+            // 只存键和结果，校验字读入时重新计算；正在被改写的条目跳过
+            const uint64_t key = check ^ result.mines ^ (result.safe * 0x9E3779B97F4A7C15ull);
+            if ((key & m_mask) != i) {
+                continue;
+            }
+            put(out, key, 8);
+            put(out, result.mines, 8);
+            put(out, result.safe, 8);
+        }
+        return static_cast<bool>(out);
+    }
+
+    bool PatternCache::load(std::istream& in) {
+        uint64_t magic, format;
+        if (!get(in, magic, 4) || !get(in, format, 4) || magic != MAGIC || format != FORMAT) {
+            return false;
+        }
+        uint64_t key;
+        while (get(in, key, 8)) {
+            Result result;
+            if (!get(in, result.mines, 8) || !get(in, result.safe, 8)) {
+                return false;
+            }
+            store(key, result);
+        }
+        return true;
+    }
+
+    PatternCache& PatternCache::shared() {
+        static PatternCache cache;
+        return cache;
+    }
+}
@@ -0,0 +1,519 @@
+#include <Probability.hpp>
+#include <Random.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <unordered_map>
+
+namespace Game {
+    namespace {
+        // 精确枚举时每条约束在状态键中占 4 位
+        constexpr int MAX_ACTIVE = 16;
+        // 布局数以 double 保存，超过这个格数改为抽样以免溢出
+        constexpr int MAX_EXACT_CELLS = 1000;
+
+        double log_choose(int n, int k) {
+            return std::lgamma(n + 1.0) - std::lgamma(k + 1.0) - std::lgamma(n - k + 1.0);
+        }
+
+        void normalize(std::vector<double>& values) {
+            double top = *std::max_element(values.begin(), values.end());
+            if (top > 0) {
+                for (double& v : values) v /= top;
+            }
+        }
+    }
+
+    void Probability::compute(const Board& board, std::stop_token stop) {
+        m_stop = std::move(stop);
+        m_cancelled = false;
+        m_width = board.getWidth();
+        m_height = board.getHeight();
+        const int cells = m_width * m_height;
+        m_probability.assign(cells, 0.0);
+        m_components.clear();
+        m_interior_cells.clear();
+        m_interior = 0;
+        m_sampled = 0;
+        if (!board.isGenerated()) {
+            std::fill(m_probability.begin(), m_probability.end(), double(board.getCount()) / cells);
+            return;
+        }
+
+        m_solver.solve(board);
+        using Knowledge = Solver::Knowledge;
+        int known_mines = 0;
+        for (int y = 0; y < m_height; ++y) {
+            for (int x = 0; x < m_width; ++x) {
+                if (m_solver.get(x, y) == Knowledge::Mine) {
+                    m_probability[y * m_width + x] = 1.0;
+                    known_mines += 1;
+                }
+            }
+        }
+
+        // 约束只涉及未知格，雷数扣除已知的雷；格子按并查集合并为分量
+        struct Global {
+            int cells[8];
+            int size;
+            int mines;
+        };
+        std::vector<Global> constraints;
+        std::vector<int> constraint_at(cells, -1);
+        std::vector<int> parent(cells, -1);
+        auto find = [&](int i) {
+            while (parent[i] != i) {
+                parent[i] = parent[parent[i]];
+                i = parent[i];
+            }
+            return i;
+        };
+        for (int y = 0; y < m_height; ++y) {
+            for (int x = 0; x < m_width; ++x) {
+                if (!board.isRevealed(x, y) || board.isMine(x, y)) {
+                    continue;
+                }
+                Global c{{}, 0, board.getMineCount(x, y)};
+                for (int ny = std::max(y - 1, 0); ny <= std::min(y + 1, m_height - 1); ++ny) {
+                    for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, m_width - 1); ++nx) {
+                        Knowledge k = m_solver.get(nx, ny);
+                        if (k == Knowledge::Unknown) {
+                            c.cells[c.size++] = ny * m_width + nx;
+                        } else if (k == Knowledge::Mine) {
+                            c.mines -= 1;
+                        }
+                    }
+                }
+                if (c.size == 0) {
+                    continue;
+                }
+                for (int j = 0; j < c.size; ++j) {
+                    if (parent[c.cells[j]] < 0) parent[c.cells[j]] = c.cells[j];
+                }
+                for (int j = 1; j < c.size; ++j) {
+                    int a = find(c.cells[0]), b = find(c.cells[j]);
+                    if (a != b) parent[std::max(a, b)] = std::min(a, b);
+                }
+                constraint_at[y * m_width + x] = static_cast<int>(constraints.size());
+                constraints.push_back(c);
+            }
+        }
+
+        // 每个分量从编号最小的格子开始沿约束广度优先排序，同时未满足的约束尽量少
+        std::vector<int> component_of(cells, -1);
+        std::vector<int> local(cells, -1);
+        for (int i = 0; i < cells; ++i) {
+            if (m_solver.get(i % m_width, i / m_width) != Knowledge::Unknown) {
+                continue;
+            }
+            if (parent[i] < 0) {
+                m_interior_cells.push_back(i);
+                continue;
+            }
+            if (find(i) != i) {
+                continue;
+            }
+            Component component;
+            component_of[i] = static_cast<int>(m_components.size());
+            component.cells.push_back(i);
+            for (size_t head = 0; head < component.cells.size(); ++head) {
+                const int cell = component.cells[head];
+                local[cell] = static_cast<int>(head);
+                const int x = cell % m_width, y = cell / m_width;
+                for (int ny = std::max(y - 1, 0); ny <= std::min(y + 1, m_height - 1); ++ny) {
+                    for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, m_width - 1); ++nx) {
+                        int j = constraint_at[ny * m_width + nx];
+                        if (j < 0) {
+                            continue;
+                        }
+                        for (int t = 0; t < constraints[j].size; ++t) {
+                            int next = constraints[j].cells[t];
+                            if (component_of[next] < 0) {
+                                component_of[next] = component_of[i];
+                                component.cells.push_back(next);
+                            }
+                        }
+                    }
+                }
+            }
+            m_components.push_back(std::move(component));
+        }
+        m_interior = static_cast<int>(m_interior_cells.size());
+        for (const Global& g : constraints) {
+            Constraint c{{}, g.size, g.mines};
+            for (int t = 0; t < g.size; ++t) {
+                c.cells[t] = local[g.cells[t]];
+            }
+            std::sort(c.cells, c.cells + c.size);
+            m_components[component_of[g.cells[0]]].constraints.push_back(c);
+        }
+
+        const int mines = board.getCount() - known_mines;
+        int frontier = 0;
+        for (const Component& c : m_components) {
+            frontier += static_cast<int>(c.cells.size());
+        }
+        const int count = static_cast<int>(m_components.size());
+        int workers = 1;
+        if (m_parallel_threshold >= 0 && frontier >= m_parallel_threshold) {
+            workers = std::clamp(static_cast<int>(std::thread::hardware_concurrency()), 1, count);
+        }
+        if (workers <= 1) {
+            for (int c = 0; c < count; ++c) {
+                solveComponent(m_components[c], mines, static_cast<uint64_t>(c));
+            }
+        } else {
+            // 分量大小差别很大，按序号动态领取
+            std::atomic<int> next = 0;
+            auto run = [&] {
+                for (int c = next++; c < count; c = next++) {
+                    solveComponent(m_components[c], mines, static_cast<uint64_t>(c));
+                }
+            };
+            std::vector<std::thread> threads;
+            threads.reserve(workers - 1);
+            for (int w = 1; w < workers; ++w) {
+                threads.emplace_back(run);
+            }
+            run();
+            for (auto& thread : threads) {
+                thread.join();
+            }
+        }
+        if (m_stop.stop_requested()) {
+            m_cancelled = true;
+            return;
+        }
+        for (const Component& c : m_components) {
+            m_sampled += c.sampled;
+        }
+        combine(mines);
+    }
+
+    int Probability::layout(const Component& component, Layout& layout) {
+        const int n = static_cast<int>(component.cells.size());
+        layout.touch.assign(n, {});
+        layout.active.assign(n + 1, {});
+        std::vector<std::vector<int>> opens(n), closes(n);
+        for (int j = 0; j < static_cast<int>(component.constraints.size()); ++j) {
+            const Constraint& c = component.constraints[j];
+            for (int t = 0; t < c.size; ++t) {
+                layout.touch[c.cells[t]].emplace_back(j, c.size - t - 1);
+            }
+            opens[c.cells[0]].push_back(j);
+            closes[c.cells[c.size - 1]].push_back(j);
+        }
+        size_t widest = 0;
+        for (int i = 0; i < n; ++i) {
+            std::vector<int>& next = layout.active[i + 1];
+            next = layout.active[i];
+            next.insert(next.end(), opens[i].begin(), opens[i].end());
+            std::erase_if(next, [&](int j) { return std::find(closes[i].begin(), closes[i].end(), j) != closes[i].end(); });
+            widest = std::max(widest, next.size());
+        }
+        return static_cast<int>(widest);
+    }
+
+    bool Probability::enumerate(Component& component, const Layout& layout, int max_mines) const {
+        const int n = static_cast<int>(component.cells.size());
+        const int K = std::min(n, max_mines) + 1;
+        std::vector<int> rem(component.constraints.size());
+        std::vector<std::vector<uint64_t>> keys(n + 1);
+        std::vector<std::vector<std::array<int, 2>>> child(n);
+        // fw[i][s * K + a]：前 i 格用 a 个雷到达状态 s 的部分布局数
+        std::vector<std::vector<double>> fw(n + 1);
+        std::unordered_map<uint64_t, int> index;
+        std::size_t table = K;
+        keys[0].push_back(0);
+        fw[0].assign(K, 0.0);
+        fw[0][0] = 1.0;
+
+        for (int i = 0; i < n; ++i) {
+            if (m_stop.stop_requested()) {
+                return false;
+            }
+            const auto& before = layout.active[i];
+            const auto& after = layout.active[i + 1];
+            index.clear();
+            child[i].assign(keys[i].size(), {-1, -1});
+            for (size_t s = 0; s < keys[i].size(); ++s) {
+                for (size_t t = 0; t < before.size(); ++t) {
+                    rem[before[t]] = static_cast<int>((keys[i][s] >> (4 * t)) & 0xF);
+                }
+                for (auto [j, left] : layout.touch[i]) {
+                    if (component.constraints[j].cells[0] == i) {
+                        rem[j] = component.constraints[j].mines;
+                    }
+                }
+                for (int v = 0; v < 2; ++v) {
+                    bool ok = true;
+                    for (auto [j, left] : layout.touch[i]) {
+                        int r = rem[j] - v;
+                        ok &= r >= 0 && r <= left;
+                    }
+                    if (!ok) {
+                        continue;
+                    }
+                    for (auto [j, left] : layout.touch[i]) rem[j] -= v;
+                    uint64_t key = 0;
+                    for (size_t t = 0; t < after.size(); ++t) {
+                        key |= uint64_t(rem[after[t]]) << (4 * t);
+                    }
+                    for (auto [j, left] : layout.touch[i]) rem[j] += v;
+
+                    auto [it, inserted] = index.try_emplace(key, static_cast<int>(keys[i + 1].size()));
+                    if (inserted) {
+                        keys[i + 1].push_back(key);
+                        fw[i + 1].resize(fw[i + 1].size() + K, 0.0);
+                        table += K;
+                        if (table > m_table_limit) {
+                            return false;
+                        }
+                    }
+                    const int target = it->second;
+                    child[i][s][v] = target;
+                    const double* from = &fw[i][s * K];
+                    double* to = &fw[i + 1][target * K];
+                    for (int a = 0; a + v < K && a <= i; ++a) {
+                        to[a + v] += from[a];
+                    }
+                }
+            }
+        }
+
+        component.weights.assign(K, 0.0);
+        component.mined.assign(static_cast<size_t>(n) * K, 0.0);
+        if (keys[n].empty()) {
+            return true;
+        }
+        // 反向：bw[s * K + b] 为从状态 s 用 b 个雷补全剩余格子的布局数
+        std::vector<double> bw(K, 0.0), prev;
+        bw[0] = 1.0;
+        for (int i = n - 1; i >= 0; --i) {
+            prev.assign(keys[i].size() * K, 0.0);
+            double* mined = &component.mined[static_cast<size_t>(i) * K];
+            for (size_t s = 0; s < keys[i].size(); ++s) {
+                double* to = &prev[s * K];
+                if (int c = child[i][s][0]; c >= 0) {
+                    for (int b = 0; b < K; ++b) to[b] += bw[c * K + b];
+                }
+                if (int c = child[i][s][1]; c >= 0) {
+                    const double* from = &bw[c * K];
+                    for (int b = 0; b + 1 < K; ++b) to[b + 1] += from[b];
+                    // 第 i 格是雷：前缀 a 个雷、后缀 b 个雷，共 a + b + 1 个
+                    const double* head = &fw[i][s * K];
+                    for (int a = 0; a <= std::min(i, K - 2); ++a) {
+                        if (head[a] == 0) continue;
+                        for (int b = 0; a + b + 1 < K && b < n - i; ++b) {
+                            mined[a + b + 1] += head[a] * from[b];
+                        }
+                    }
+                }
+            }
+            std::swap(bw, prev);
+            fw[i + 1] = {};
+        }
+        std::copy(bw.begin(), bw.begin() + K, component.weights.begin());
+        return true;
+    }
+
+    void Probability::sample(Component& component, const Layout& layout, int max_mines, uint64_t seed) const {
+        // 每条随机路径在每格均匀选择一个仍可行的取值，成功时的权重为 2^(二选一的次数)，
+        // 其期望恰为布局数；先走一遍求最大指数，再用同一随机序列按相对权重累加，避免溢出
+        const int n = static_cast<int>(component.cells.size());
+        const int K = std::min(n, max_mines) + 1;
+        component.weights.assign(K, 0.0);
+        component.mined.assign(static_cast<size_t>(n) * K, 0.0);
+        std::vector<int> rem(component.constraints.size());
+        std::vector<int> path;
+        int top = -1;
+        for (int pass = 0; pass < 2; ++pass) {
+            Xoshiro256 random(SplitMix64::mix(seed));
+            for (int t = 0; t < m_samples; ++t) {
+                if (m_stop.stop_requested()) {
+                    return;
+                }
+                path.clear();
+                int doublings = 0;
+                bool alive = true;
+                for (int i = 0; i < n && alive; ++i) {
+                    bool ok[2];
+                    for (int v = 0; v < 2; ++v) {
+                        ok[v] = true;
+                        for (auto [j, left] : layout.touch[i]) {
+                            int r = (component.constraints[j].cells[0] == i ? component.constraints[j].mines : rem[j]) - v;
+                            ok[v] &= r >= 0 && r <= left;
+                        }
+                    }
+                    int v;
+                    if (ok[0] && ok[1]) {
+                        v = static_cast<int>(random() >> 63);
+                        doublings += 1;
+                    } else if (ok[0] || ok[1]) {
+                        v = ok[1];
+                    } else {
+                        alive = false;
+                        break;
+                    }
+                    for (auto [j, left] : layout.touch[i]) {
+                        rem[j] = (component.constraints[j].cells[0] == i ? component.constraints[j].mines : rem[j]) - v;
+                    }
+                    if (v) path.push_back(i);
+                }
+                const int k = static_cast<int>(path.size());
+                if (!alive || k >= K) {
+                    continue;
+                }
+                if (pass == 0) {
+                    top = std::max(top, doublings);
+                    continue;
+                }
+                const double weight = std::ldexp(1.0, doublings - top);
+                component.weights[k] += weight;
+                for (int i : path) {
+                    component.mined[static_cast<size_t>(i) * K + k] += weight;
+                }
+            }
+            if (top < 0) {
+                break;
+            }
+        }
+    }
+
+    void Probability::solveComponent(Component& component, int max_mines, uint64_t seed) const {
+        if (m_stop.stop_requested()) {
+            return;
+        }
+        Layout lay;
+        const int widest = layout(component, lay);
+        const int n = static_cast<int>(component.cells.size());
+        if (widest > MAX_ACTIVE || n > MAX_EXACT_CELLS || !enumerate(component, lay, max_mines)) {
+            if (m_stop.stop_requested()) {
+                return;
+            }
+            component.sampled = true;
+            sample(component, lay, max_mines, seed);
+        }
+        // 同一分量的各项同比缩放不影响概率
+        double top = *std::max_element(component.weights.begin(), component.weights.end());
+        if (top > 0) {
+            for (double& w : component.weights) w /= top;
+            for (double& m : component.mined) m /= top;
+        }
+    }
+
+    void Probability::combine(int mines) {
+        const int count = static_cast<int>(m_components.size());
+        const int R = m_interior;
+        int total = 0;
+        for (const Component& c : m_components) {
+            total += static_cast<int>(c.weights.size()) - 1;
+        }
+        total = std::min(total, mines);
+        if (total < 0) {
+            return;
+        }
+
+        // B[m] = C(R, mines - m)：边界上有 m 个雷时内部格的布法数，按最大项缩放
+        std::vector<double> B(total + 1, 0.0);
+        {
+            std::vector<double> logs(total + 1, -INFINITY);
+            double top = -INFINITY;
+            for (int m = 0; m <= total; ++m) {
+                if (mines - m >= 0 && mines - m <= R) {
+                    logs[m] = log_choose(R, mines - m);
+                    top = std::max(top, logs[m]);
+                }
+            }
+            for (int m = 0; m <= total; ++m) {
+                B[m] = std::isinf(logs[m]) ? 0.0 : std::exp(logs[m] - top);
+            }
+        }
+
+        // pre[c]：前 c 个分量的雷数分布
+        std::vector<std::vector<double>> pre(count + 1);
+        pre[0] = {1.0};
+        for (int c = 0; c < count; ++c) {
+            const auto& w = m_components[c].weights;
+            const auto& p = pre[c];
+            std::vector<double> next(std::min<size_t>(p.size() + w.size() - 1, total + 1), 0.0);
+            for (size_t i = 0; i < p.size(); ++i) {
+                if (p[i] == 0) continue;
+                for (size_t k = 0; k < w.size() && i + k < next.size(); ++k) {
+                    next[i + k] += p[i] * w[k];
+                }
+            }
+            normalize(next);
+            pre[c + 1] = std::move(next);
+        }
+
+        // G 从后往前累积：G[m] = sum_j S[j] * B[m + j]，S 为当前分量之后各分量的雷数分布
+        std::vector<double> G = B, next;
+        for (int c = count - 1; c >= 0; --c) {
+            Component& component = m_components[c];
+            const auto& w = component.weights;
+            const auto& p = pre[c];
+            const int K = static_cast<int>(w.size());
+            std::vector<double> Q(K, 0.0);
+            for (int k = 0; k < K; ++k) {
+                for (size_t i = 0; i < p.size() && i + k < G.size(); ++i) {
+                    Q[k] += p[i] * G[i + k];
+                }
+            }
+            double norm = 0;
+            for (int k = 0; k < K; ++k) {
+                norm += w[k] * Q[k];
+            }
+            const int n = static_cast<int>(component.cells.size());
+            for (int i = 0; i < n; ++i) {
+                double sum = 0;
+                for (int k = 0; k < K; ++k) {
+                    sum += component.mined[static_cast<size_t>(i) * K + k] * Q[k];
+                }
+                m_probability[component.cells[i]] = norm > 0 ? sum / norm : 0.0;
+            }
+
+            next.assign(G.size(), 0.0);
+            for (size_t m = 0; m < G.size(); ++m) {
+                for (int k = 0; k < K && m + k < G.size(); ++k) {
+                    next[m] += w[k] * G[m + k];
+                }
+            }
+            normalize(next);
+            std::swap(G, next);
+            // 释放不再需要的逐格数据
+            component.mined = {};
+        }
+
+        if (R > 0) {
+            double weight = 0, expected = 0;
+            const auto& p = pre[count];
+            for (size_t m = 0; m < p.size(); ++m) {
+                weight += p[m] * B[m];
+                expected += p[m] * B[m] * (mines - static_cast<int>(m));
+            }
+            const double interior = weight > 0 ? expected / (weight * R) : 0.0;
+            for (int i : m_interior_cells) {
+                m_probability[i] = interior;
+            }
+        }
+    }
+
+    int Probability::getSafest() const {
+        if (!m_solver.getSafe().empty()) {
+            return m_solver.getSafe().front();
+        }
+        int best = -1;
+        for (const Component& c : m_components) {
+            for (int i : c.cells) {
+                if (best < 0 || m_probability[i] < m_probability[best]) best = i;
+            }
+        }
+        for (int i : m_interior_cells) {
+            if (best < 0 || m_probability[i] < m_probability[best]) best = i;
+        }
+        return best;
+    }
+}
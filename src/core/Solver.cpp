@@ -0,0 +1,466 @@
+#include <Solver.hpp>
+#include <Random.hpp>
+#include <algorithm>
+#include <bit>
+#include <optional>
+
+namespace Game {
+    namespace {
+        // 模式中约束的偏移在 [-2, 2] 内，共 25 个位置，剩余雷数取 [0, 8]
+        constexpr int MAX_PATTERN = 25;
+        // 单个模式最多搜索的赋值结点数，超出时视为无结论
+        constexpr int MAX_PATTERN_NODES = 1 << 14;
+
+        // 键与约束的绝对位置无关，同一形状出现在棋盘各处都命中同一条目
+        // 种子固定，保存的缓存在下次运行时仍然有效
+        struct Zobrist {
+            uint64_t cell[64];
+            uint64_t constraint[MAX_PATTERN][9];
+        };
+
+        const Zobrist& zobrist() {
+            static const Zobrist table = [] {
+                Zobrist z;
+                SplitMix64 random(0x5A0B215Eull);
+                for (auto& key : z.cell) key = random();
+                for (auto& row : z.constraint) {
+                    for (auto& key : row) key = random();
+                }
+                return z;
+            }();
+            return table;
+        }
+    }
+
+    bool Solver::solve(const Board& board, int max_steps, std::stop_token stop) {
+        m_width = board.getWidth();
+        m_height = board.getHeight();
+        m_known.assign(m_width * m_height, Knowledge::Unknown);
+        m_constraint_at.assign(m_width * m_height, -1);
+        m_active_stride = (m_width + 63) / 64;
+        m_active.assign(m_height * m_active_stride, 0);
+        m_constraints.clear();
+        m_free.clear();
+        m_queue.clear();
+        m_pattern_queue.clear();
+        m_safe.clear();
+        m_mines.clear();
+        if (!board.isGenerated()) {
+            return true;
+        }
+
+        // 布雷后各行都已是当前纪元，直接按字遍历翻开平面
+        const auto& revealed = board.getRevealedPlane();
+        const int stride = board.getStride();
+        // 每行检查一次是否被取消，整盘建表在大棋盘上比推理本身更耗时
+        auto for_each_revealed = [&](auto&& f) {
+            for (int y = 0; y < m_height; ++y) {
+                if (stop.stop_requested()) {
+                    return false;
+                }
+                for (int k = 0; k < stride; ++k) {
+                    for (Board::Word bits = revealed[y * stride + k]; bits; bits &= bits - 1) {
+                        f(k * Board::WORD_BITS + std::countr_zero(bits), y);
+                    }
+                }
+            }
+            return true;
+        };
+        const bool complete = for_each_revealed([&](int x, int y) {
+            // 踩到的雷也是已知的雷
+            m_known[y * m_width + x] = board.isMine(x, y) ? Knowledge::Mine : Knowledge::Safe;
+        }) && for_each_revealed([&](int x, int y) { addConstraint(board, x, y); });
+        if (!complete) {
+            return false;
+        }
+        // 整盘重建时每条约束都检查一次模式，不必按格子逐个登记
+        for (int i = static_cast<int>(m_constraints.size()); i-- > 0;) {
+            if (m_constraints[i].mask) {
+                m_constraints[i].pattern_queued = true;
+                m_pattern_queue.push_back(i);
+            }
+        }
+        return settle(max_steps, stop);
+    }
+
+    void Solver::reveal(const Board& board, int x, int y) {
+        const Knowledge value = board.isMine(x, y) ? Knowledge::Mine : Knowledge::Safe;
+        if (m_known[y * m_width + x] == Knowledge::Unknown) {
+            m_known[y * m_width + x] = value;
+            learn(x, y, value);
+        }
+        if (m_constraint_at[y * m_width + x] < 0) {
+            addConstraint(board, x, y);
+            enqueuePatterns(x, y, 2);
+        }
+    }
+
+    void Solver::cover(const Board& board, std::span<const int> covered) {
+        if (m_stamp.size() != m_known.size()) {
+            m_stamp.assign(m_known.size(), 0);
+            m_epoch = 0;
+        }
+        if (++m_epoch == 0) {
+            std::fill(m_stamp.begin(), m_stamp.end(), 0);
+            m_epoch = 1;
+        }
+        // 结论只沿共享的未翻开格传播：从这些格子出发，交替经过未翻开格和以它们为邻的约束，
+        // 得到的区域之外的结论都与它们无关，多个格子一起处理以免区域被重复遍历
+        std::vector<int>& cells = m_region;
+        cells.clear();
+        auto visit = [&](int x, int y) {
+            const int i = y * m_width + x;
+            if (!board.isRevealed(x, y) && m_stamp[i] != m_epoch) {
+                m_stamp[i] = m_epoch;
+                cells.push_back(i);
+            }
+        };
+        for (int i : covered) {
+            const int x = i % m_width, y = i / m_width;
+            // 以该格为中心的约束随之作废，由它推出的结论在它周围的格子上
+            if (int c = m_constraint_at[i]; c >= 0) {
+                m_constraints[c].mask = 0;
+                setActive(m_constraints[c]);
+                m_constraint_at[i] = -1;
+                m_free.push_back(c);
+            }
+            for (int ny = std::max(y - 1, 0); ny <= std::min(y + 1, m_height - 1); ++ny) {
+                for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, m_width - 1); ++nx) {
+                    visit(nx, ny);
+                }
+            }
+        }
+        std::vector<int> constraints;
+        for (size_t head = 0; head < cells.size(); ++head) {
+            const int cx = cells[head] % m_width, cy = cells[head] / m_width;
+            m_known[cells[head]] = Knowledge::Unknown;
+            for (int ny = std::max(cy - 1, 0); ny <= std::min(cy + 1, m_height - 1); ++ny) {
+                for (int nx = std::max(cx - 1, 0); nx <= std::min(cx + 1, m_width - 1); ++nx) {
+                    const int centre = ny * m_width + nx;
+                    // 约束格本身已翻开，不会进入格子队列，借用它的印记表示约束已收集
+                    if (m_constraint_at[centre] < 0 || m_stamp[centre] == m_epoch) {
+                        continue;
+                    }
+                    m_stamp[centre] = m_epoch;
+                    constraints.push_back(m_constraint_at[centre]);
+                    for (int my = std::max(ny - 1, 0); my <= std::min(ny + 1, m_height - 1); ++my) {
+                        for (int mx = std::max(nx - 1, 0); mx <= std::min(nx + 1, m_width - 1); ++mx) {
+                            visit(mx, my);
+                        }
+                    }
+                }
+            }
+        }
+        for (int c : constraints) {
+            measure(board, m_constraints[c]);
+            setActive(m_constraints[c]);
+            enqueue(c);
+        }
+        // 区域内的格子都在这些约束的 3x3 内，模式可能因此改变的约束离它们不超过 4
+        for (int c : constraints) {
+            enqueuePatterns(m_constraints[c].x, m_constraints[c].y, 4);
+        }
+    }
+
+    bool Solver::settle(int max_steps, std::stop_token stop) {
+        // 栈式工作表：刚改动的约束先处理，结论沿开口边缘就近传播
+        // 局部模式较慢，只在简单规则都无果时才处理
+        for (int step = 0; step != max_steps; ++step) {
+            if (stop.stop_requested()) {
+                return false;
+            }
+            if (!m_queue.empty()) {
+                int c = m_queue.back();
+                m_queue.pop_back();
+                m_constraints[c].queued = false;
+                apply(c);
+            } else if (!m_pattern_queue.empty()) {
+                int c = m_pattern_queue.back();
+                m_pattern_queue.pop_back();
+                m_constraints[c].pattern_queued = false;
+                applyPattern(c);
+            } else {
+                break;
+            }
+        }
+        return m_queue.empty() && m_pattern_queue.empty();
+    }
+
+    void Solver::addConstraint(const Board& board, int x, int y) {
+        if (m_known[y * m_width + x] != Knowledge::Safe || board.getMineCount(x, y) == 0) {
+            return;
+        }
+        // 周围已全部确定的约束也保留，撤销翻开后可能重新起作用
+        Constraint c{x, y, 0, 0, false, false};
+        measure(board, c);
+        int i = static_cast<int>(m_constraints.size());
+        if (!m_free.empty()) {
+            i = m_free.back();
+            m_free.pop_back();
+            m_constraints[i] = c;
+        } else {
+            m_constraints.push_back(c);
+        }
+        m_constraint_at[y * m_width + x] = i;
+        setActive(c);
+        enqueue(i);
+    }
+
+    void Solver::measure(const Board& board, Constraint& c) const {
+        c.mask = 0;
+        c.mines = board.getMineCount(c.x, c.y);
+        for (int ny = std::max(c.y - 1, 0); ny <= std::min(c.y + 1, m_height - 1); ++ny) {
+            for (int nx = std::max(c.x - 1, 0); nx <= std::min(c.x + 1, m_width - 1); ++nx) {
+                Knowledge k = m_known[ny * m_width + nx];
+                if (k == Knowledge::Unknown) {
+                    c.mask |= uint64_t(1) << bitOf(nx - c.x, ny - c.y);
+                } else if (k == Knowledge::Mine) {
+                    c.mines -= 1;
+                }
+            }
+        }
+    }
+
+    void Solver::enqueue(int c) {
+        if (!m_constraints[c].queued && m_constraints[c].mask) {
+            m_constraints[c].queued = true;
+            m_queue.push_back(c);
+        }
+    }
+
+    void Solver::setActive(const Constraint& c) {
+        uint64_t& word = m_active[c.y * m_active_stride + c.x / 64];
+        const uint64_t bit = uint64_t(1) << (c.x % 64);
+        word = c.mask ? word | bit : word & ~bit;
+    }
+
+    template <typename F>
+    void Solver::forEachActive(int x, int y, int radius, F&& f) const {
+        const int x0 = std::max(x - radius, 0), x1 = std::min(x + radius, m_width - 1);
+        for (int cy = std::max(y - radius, 0); cy <= std::min(y + radius, m_height - 1); ++cy) {
+            const uint64_t* row = &m_active[cy * m_active_stride];
+            for (int k = x0 / 64; k <= x1 / 64; ++k) {
+                uint64_t bits = row[k];
+                if (k == x0 / 64) bits &= ~uint64_t(0) << (x0 % 64);
+                if (k == x1 / 64) bits &= ~uint64_t(0) >> (63 - x1 % 64);
+                for (; bits; bits &= bits - 1) {
+                    const int cx = k * 64 + std::countr_zero(bits);
+                    if (!f(cx, cy, m_constraint_at[cy * m_width + cx])) {
+                        return;
+                    }
+                }
+            }
+        }
+    }
+
+    void Solver::enqueuePatterns(int x, int y, int radius) {
+        forEachActive(x, y, radius, [&](int, int, int i) {
+            if (!m_constraints[i].pattern_queued) {
+                m_constraints[i].pattern_queued = true;
+                m_pattern_queue.push_back(i);
+            }
+            return true;
+        });
+    }
+
+    void Solver::mark(int x, int y, Knowledge value) {
+        Knowledge& k = m_known[y * m_width + x];
+        if (k != Knowledge::Unknown) {
+            return;
+        }
+        k = value;
+        (value == Knowledge::Safe ? m_safe : m_mines).push_back(y * m_width + x);
+        learn(x, y, value);
+    }
+
+    void Solver::learn(int x, int y, Knowledge value) {
+        for (int cy = std::max(y - 1, 0); cy <= std::min(y + 1, m_height - 1); ++cy) {
+            for (int cx = std::max(x - 1, 0); cx <= std::min(x + 1, m_width - 1); ++cx) {
+                int i = m_constraint_at[cy * m_width + cx];
+                if (i < 0) {
+                    continue;
+                }
+                Constraint& c = m_constraints[i];
+                c.mask &= ~(uint64_t(1) << bitOf(x - cx, y - cy));
+                c.mines -= value == Knowledge::Mine;
+                if (!c.mask) {
+                    setActive(c);
+                }
+                // 配对规则在两个方向上都检查，只需重新处理改动过的约束
+                enqueue(i);
+            }
+        }
+        // 模式包含距中心 2 以内的约束，它们的格子距中心不超过 3
+        enqueuePatterns(x, y, 3);
+    }
+
+    void Solver::markAll(const Constraint& c, uint64_t mask, Knowledge value) {
+        while (mask) {
+            int bit = std::countr_zero(mask);
+            mask &= mask - 1;
+            mark(c.x + bit % 8 - 3, c.y + bit / 8 - 3, value);
+        }
+    }
+
+    void Solver::apply(int i) {
+        const Constraint& a = m_constraints[i];
+        if (!a.mask) {
+            return;
+        }
+        if (a.mines == 0) {
+            markAll(a, a.mask, Knowledge::Safe);
+            return;
+        }
+        if (a.mines == std::popcount(a.mask)) {
+            markAll(a, a.mask, Knowledge::Mine);
+            return;
+        }
+        forEachActive(a.x, a.y, 2, [&](int, int, int j) {
+            if (j == i) {
+                return true;
+            }
+            const Constraint& b = m_constraints[j];
+            // b 平移到 a 的局部坐标，偏移不超过 2 列，不会跨行回绕
+            const int shift = (b.y - a.y) * 8 + (b.x - a.x);
+            const uint64_t bm = shift >= 0 ? b.mask << shift : b.mask >> -shift;
+            if (!(a.mask & bm)) {
+                return true;
+            }
+            // mines(a) - mines(b) = mines(a \ b) - mines(b \ a)
+            // 差值等于 |a \ b| 时 a \ b 全是雷且 b \ a 全安全，反过来同理
+            const uint64_t only_a = a.mask & ~bm, only_b = bm & ~a.mask;
+            const int diff = a.mines - b.mines;
+            uint64_t mines = 0, safe = 0;
+            if (diff == std::popcount(only_a)) {
+                mines = only_a;
+                safe = only_b;
+            } else if (-diff == std::popcount(only_b)) {
+                mines = only_b;
+                safe = only_a;
+            }
+            if (mines | safe) {
+                markAll(a, mines, Knowledge::Mine);
+                markAll(a, safe, Knowledge::Safe);
+                // 其余配对留到下一轮检查
+                enqueue(i);
+                return false;
+            }
+            return true;
+        });
+    }
+
+    void Solver::applyPattern(int i) {
+        const Constraint& a = m_constraints[i];
+        if (!a.mask) {
+            return;
+        }
+        // 距 a 不超过 2 的约束都收入模式，a 在第 0 条
+        // 不按当前是否与 a 相交筛选：已知格增多时模式只会失去已满足的约束，推出的结论只增不减，
+        // 推理结果因此与处理顺序无关
+        uint64_t masks[MAX_PATTERN];
+        int counts[MAX_PATTERN], offsets[MAX_PATTERN];
+        masks[0] = a.mask;
+        counts[0] = a.mines;
+        offsets[0] = 2 * 5 + 2;
+        int size = 1;
+        forEachActive(a.x, a.y, 2, [&](int nx, int ny, int j) {
+            const Constraint& b = m_constraints[j];
+            const int shift = (b.y - a.y) * 8 + (b.x - a.x);
+            const uint64_t bm = shift >= 0 ? b.mask << shift : b.mask >> -shift;
+            if (j != i) {
+                masks[size] = bm;
+                counts[size] = b.mines;
+                offsets[size] = (ny - a.y + 2) * 5 + nx - a.x + 2;
+                size += 1;
+            }
+            return true;
+        });
+        if (size < 2) {
+            return;
+        }
+        // 每条约束的未知格就是模式格子与其 3x3 的交集，模式由格子集合和各约束的位置、剩余雷数唯一确定
+        uint64_t cells = 0;
+        for (int k = 0; k < size; ++k) {
+            cells |= masks[k];
+        }
+        const Zobrist& z = zobrist();
+        uint64_t key = 0;
+        for (uint64_t bits = cells; bits; bits &= bits - 1) {
+            key ^= z.cell[std::countr_zero(bits)];
+        }
+        for (int k = 0; k < size; ++k) {
+            if (counts[k] < 0 || counts[k] > 8) {
+                return;
+            }
+            key ^= z.constraint[offsets[k]][counts[k]];
+        }
+        std::optional<PatternCache::Result> cached = m_cache ? m_cache->find(key) : std::nullopt;
+        // 从文件读入的条目不可信，结论必须落在模式之内
+        if (cached && ((cached->mines | cached->safe) & ~cells)) {
+            cached.reset();
+        }
+        const PatternCache::Result result = cached ? *cached : enumerate(masks, counts, size, cells);
+        if (!cached && m_cache) {
+            m_cache->store(key, result);
+        }
+        if (result.mines | result.safe) {
+            markAll(a, result.mines, Knowledge::Mine);
+            markAll(a, result.safe, Knowledge::Safe);
+        }
+    }
+
+    PatternCache::Result Solver::enumerate(const uint64_t* masks, const int* mines, int size, uint64_t cells) {
+        // 按约束逐条赋值：第 k 步只决定前面的约束没有覆盖的格子，赋值后约束 k 恰好满足，
+        // 后面的约束检查已赋的雷不超过其雷数、剩下的格子还放得下其余的雷
+        uint64_t placed[MAX_PATTERN + 1];
+        placed[0] = 0;
+        for (int k = 0; k < size; ++k) {
+            placed[k + 1] = placed[k] | masks[k];
+        }
+        // always 为每个解中都是雷的格子之交，ever 为至少在一个解中是雷的格子之并
+        uint64_t always = ~uint64_t(0), ever = 0, assigned = 0;
+        int nodes = 0;
+        bool solved = false;
+        auto search = [&](auto&& self, int k) -> bool {
+            if (k == size) {
+                always &= assigned;
+                ever |= assigned;
+                solved = true;
+                // 已没有格子可能被推出时提前结束
+                return (always | (cells & ~ever)) != 0;
+            }
+            const uint64_t fresh = masks[k] & ~placed[k];
+            const int need = mines[k] - std::popcount(assigned & masks[k]);
+            if (need < 0 || need > std::popcount(fresh)) {
+                return true;
+            }
+            // 依次取 fresh 的所有子集
+            uint64_t subset = 0;
+            do {
+                if (std::popcount(subset) == need) {
+                    if (++nodes > MAX_PATTERN_NODES) {
+                        return false;
+                    }
+                    assigned |= subset;
+                    bool feasible = true;
+                    for (int j = k + 1; j < size && feasible; ++j) {
+                        const int rest = mines[j] - std::popcount(assigned & masks[j]);
+                        feasible = rest >= 0 && rest <= std::popcount(masks[j] & ~placed[k + 1]);
+                    }
+                    const bool go_on = !feasible || self(self, k + 1);
+                    assigned &= ~subset;
+                    if (!go_on) {
+                        return false;
+                    }
+                }
+                subset = (subset - fresh) & fresh;
+            } while (subset);
+            return true;
+        };
+        // 搜索未完成或约束互相矛盾时不给结论
+        if (!search(search, 0) || !solved) {
+            return {0, 0};
+        }
+        return {always, cells & ~ever};
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <Board.hpp>
+#include <Probability.hpp>
+#include <Solver.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace Game {
+    enum class OverlayMode : uint8_t {
+        None,
+        // Solver 推出的安全格和雷
+        Markers,
+        // 每格是雷的精确概率
+        Probabilities,
+    };
+
+    // 一次后台分析的结果，每格一个值：0 到 1 为是雷的概率（标记模式下只有 0 和 1），
+    // 已翻开或没有结论的格子为负数
+    struct AnalysisResult {
+        int width = 0, height = 0;
+        // 提交时给出的棋盘版本
+        uint64_t version = 0;
+        OverlayMode mode = OverlayMode::None;
+        std::vector<float> values;
+    };
+
+    // 在后台线程中分析棋盘，供渲染叠加层使用
+    // 提交新局面时取消尚未完成的旧任务；完成的结果写入双缓冲中的后台槽位再原子地交换，
+    // 渲染线程读取前台槽位时只做一次 CAS 登记，从不等待
+    class AnalysisWorker {
+    public:
+        AnalysisWorker();
+        ~AnalysisWorker();
+
+        AnalysisWorker(const AnalysisWorker&) = delete;
+        AnalysisWorker& operator=(const AnalysisWorker&) = delete;
+
+        // 复制棋盘中分析需要的位平面并排队分析，取消正在进行的任务
+        void submit(const Board& board, OverlayMode mode, uint64_t version);
+        // 取消正在进行和排队的任务，已发布的结果保留
+        void cancel();
+
+        // 以最近发布的结果调用 f(const AnalysisResult&)，还没有结果时返回 false
+        // f 执行期间工作线程不会改写这份结果
+        template <typename F>
+        bool read(F&& f) const {
+            if (!m_published.load(std::memory_order_acquire)) {
+                return false;
+            }
+            uint32_t state = m_state.load(std::memory_order_relaxed);
+            uint32_t slot;
+            do {
+                slot = state & FRONT;
+            } while (!m_state.compare_exchange_weak(state, state | (READING << slot), std::memory_order_acquire, std::memory_order_relaxed));
+            f(static_cast<const AnalysisResult&>(m_slots[slot]));
+            m_state.fetch_and(~(READING << slot), std::memory_order_release);
+            return true;
+        }
+
+    private:
+        // m_state 的第 0 位为前台槽位，第 1、2 位表示读者正在使用对应的槽位
+        static constexpr uint32_t FRONT = 1;
+        static constexpr uint32_t READING = 2;
+
+        void run();
+        // 把 m_values 写入后台槽位并交换到前台
+        void publish(const Board& board, OverlayMode mode, uint64_t version);
+
+        mutable std::atomic<uint32_t> m_state{0};
+        std::atomic<bool> m_published{false};
+        AnalysisResult m_slots[2];
+
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        // 待分析的快照，与工作线程的 m_board 交换，两者的缓冲区反复复用
+        Board m_job;
+        bool m_has_job = false;
+        OverlayMode m_job_mode = OverlayMode::None;
+        uint64_t m_job_version = 0;
+        std::stop_source m_cancel;
+        bool m_stop = false;
+
+        // 以下只在工作线程中使用
+        Board m_board;
+        Solver m_solver;
+        Probability m_probability;
+        std::vector<float> m_values;
+
+        std::thread m_worker;
+    };
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <Board.hpp>
+#include <Random.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace Game {
+    // 同尺寸、同雷数的 64 局同时求解，用于胜率和策略的批量实验
+    // 按位切片存放：每格一个 64 位字，第 b 位属于第 b 局，翻开和推理对所有局执行同一串位运算
+    // 推理只用单格规则：数字等于周围已推出的雷数时其余未知格安全，等于周围未翻开格数时它们都是雷
+    // 比 Solver 弱，但不需要逐局的约束表；需要完整推理时仍对单局使用 Solver
+    class BatchSolver {
+    public:
+        // 每个位对应一局
+        using Lanes = uint64_t;
+        static constexpr int LANES = 64;
+
+        // 尺寸无效或雷数放不下（首次点击周围 3x3 不布雷）时抛出 invalid_argument
+        BatchSolver(int w, int h, int count);
+
+        int getWidth() const { return m_width; }
+        int getHeight() const { return m_height; }
+        int getCount() const { return m_count; }
+
+        // 清空所有局，之后需要重新布雷或导入
+        void clear();
+        // 清空后为每局在 (px, py) 周围 3x3 之外均匀随机布雷，(px, py) 不在棋盘内时抛出 invalid_argument
+        // 直接写入位切片，不经过 Board；需要可复现的 BoardKey 时用 Board 布雷后 load
+        void generate(int px, int py, RandomRef random);
+        // 把已布雷的同尺寸棋盘的雷放入第 lane 局，清除该局的进度
+        void load(int lane, const Board& board);
+
+        // 在 lanes 中的各局翻开 (x, y)，零格连锁展开，踩雷的局记为失败
+        void reveal(int x, int y, Lanes lanes);
+        // 对所有进行中的局反复推理并翻开安全格，直到都不再变化，返回扫描的轮数
+        // 结束后仍在进行的局都需要猜
+        int deduce();
+        // 每个进行中的局随机翻开一个未知格（未翻开且未推出是雷）
+        void guess(RandomRef random);
+        // 从 (px, py) 开始把所有局下完：推理，卡住就猜，返回获胜的局
+        Lanes play(int px, int py, RandomRef random);
+
+        // 已导入的局
+        Lanes getLoaded() const { return m_loaded; }
+        Lanes getWon() const { return m_won; }
+        Lanes getLost() const { return m_lost; }
+        Lanes getActive() const { return m_loaded & ~m_won & ~m_lost; }
+        // 各局中 (x, y) 的状态
+        Lanes getMines(int x, int y) const { return m_mines[index(x, y)]; }
+        Lanes getRevealed(int x, int y) const { return m_revealed[index(x, y)]; }
+        Lanes getFlagged(int x, int y) const { return m_flags[index(x, y)]; }
+        // 第 lane 局中翻开的非雷格数
+        int getRevealedCount(int lane) const;
+
+    private:
+        // 四个位平面表示的 0 到 8
+        struct Count {
+            Lanes b0 = 0, b1 = 0, b2 = 0, b3 = 0;
+        };
+
+        // 棋盘四周各留一圈哨兵格：不是雷、视为已翻开、不是零格，邻格访问不用判断边界
+        int index(int x, int y) const { return (y + 1) * m_padded + x + 1; }
+        // 8 个邻格的位平面逐位相加
+        static Count sum(const Lanes (&bits)[8]);
+        static Lanes equal(const Count& a, const Count& b) {
+            return ~((a.b0 ^ b.b0) | (a.b1 ^ b.b1) | (a.b2 ^ b.b2) | (a.b3 ^ b.b3));
+        }
+
+        // 由雷平面重新计算数字和零格
+        void updateCounts();
+        // 在已翻开的零格周围展开，正反两个方向交替扫描直到不再变化
+        void flood();
+        // 一轮单格推理，推出的安全格直接翻开，返回是否有变化
+        bool deducePass();
+        // 有局结束时更新胜负
+        void settle();
+
+        int m_width, m_height, m_count;
+        int m_padded;
+        // 实际格子的下标，按行优先
+        std::vector<int> m_cells;
+        int m_neighbours[8];
+
+        std::vector<Lanes> m_mines;
+        std::vector<Lanes> m_revealed;
+        std::vector<Lanes> m_flags;
+        std::vector<Lanes> m_zeros;
+        std::vector<Count> m_numbers;
+        bool m_counts_dirty = false;
+        // 有新翻开的零格，需要展开
+        bool m_flood_needed = false;
+
+        Lanes m_loaded = 0, m_won = 0, m_lost = 0;
+    };
+}
@@ -0,0 +1,332 @@
+#pragma once
+
+#include <Random.hpp>
+#include <Topology.hpp>
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Game {
+    enum class CellState : uint8_t {
+        // 没有点击，暨没有初始化雷的情况
+        Empty,
+        // 标记为雷
+        Mine,
+        // 标记为旗
+        Flag,
+        // 默认（雷区已经初始）
+        Default,
+        // 已经被打开
+        Uncovered,
+        // 在分帧翻开的队列中，视同已打开
+        Revealing,
+    };
+
+    // 一次操作的结果，由上层转换为 GameWin / GameOver 消息
+    enum class BoardResult {
+        None,
+        Win,
+        Lose,
+    };
+
+    // 一次操作中单个格子的状态变化
+    struct CellChange {
+        // 整盘变化，逐格的旧状态不列出：
+        // 重置为 {ALL_CELLS, Default, Empty}，所有格子变为 Empty；
+        // 布雷为 {ALL_CELLS, Empty, Default}，只有处于 Empty 的格子变为 Default，已插的旗保持不变
+        static constexpr int ALL_CELLS = -1;
+        // 格子下标 y * width + x
+        int index;
+        CellState before, after;
+    };
+
+    // 一块区域内的格子统计
+    struct BoardStats {
+        int cells = 0, mines = 0, revealed = 0, flagged = 0;
+        // 插在雷上的旗
+        int flag_mines = 0;
+
+        int covered() const { return cells - revealed; }
+        BoardStats& operator+=(const BoardStats& other) {
+            cells += other.cells;
+            mines += other.mines;
+            revealed += other.revealed;
+            flagged += other.flagged;
+            flag_mines += other.flag_mines;
+            return *this;
+        }
+    };
+
+    // 可以完整复现一局雷区的信息
+    struct BoardKey {
+        uint64_t seed = 0;
+        int width = 0, height = 0, count = 0;
+        // 首次点击的位置
+        int x = 0, y = 0;
+        RandomKind engine = RandomKind::Xoshiro256;
+
+        // 形如 "xoshiro256:30x16:99:5,7:0123456789abcdef"
+        std::string toString() const;
+        static BoardKey parse(std::string_view text);
+
+        bool operator==(const BoardKey&) const = default;
+    };
+
+    // 不依赖 SFML 的雷区核心
+    // 雷、翻开、旗子各是一张按行对齐到 64 位字的位平面，周围雷数以 4 位打包存储
+    class Board {
+    public:
+        using Word = uint64_t;
+        static constexpr int WORD_BITS = 64;
+
+        Board() = default;
+        Board(int w, int h, int count);
+
+        int getWidth() const { return m_width; }
+        int getHeight() const { return m_height; }
+        int getCount() const { return m_count; }
+        // 每行占用的字数
+        int getStride() const { return m_stride; }
+        // 剩余未翻开的安全格
+        int getUncovered() const { return m_uncovered; }
+        int getFlagMineCount() const { return m_flag_mine_count; }
+        bool isGenerated() const { return m_generated; }
+
+        bool contains(int x, int y) const { return x >= 0 && x < m_width && y >= 0 && y < m_height; }
+        int index(int x, int y) const { return y * m_width + x; }
+        // 对 (x, y) 在棋盘内的每个邻居调用 f(nx, ny)，偏移取自 Topology::Square8
+        template <typename F>
+        void forEachNeighbour(int x, int y, F&& f) const {
+            for (const auto& o : Topology::Square8::OFFSETS[0]) {
+                const int nx = x + o.dx, ny = y + o.dy;
+                if (contains(nx, ny)) f(nx, ny);
+            }
+        }
+
+        bool isMine(int x, int y) const { return m_generated && testBit(m_mines, x, y); }
+        bool isRevealed(int x, int y) const { return !isStale(y) && testBit(m_revealed, x, y); }
+        bool isFlagged(int x, int y) const { return !isStale(y) && testBit(m_flags, x, y); }
+        bool isPending(int x, int y) const { return !isStale(y) && testBit(m_pending, x, y); }
+        int getMineCount(int x, int y) const {
+            if (!m_generated) return 0;
+            int i = index(x, y);
+            return (m_counts[i >> 1] >> ((i & 1) * 4)) & 0xF;
+        }
+        CellState getState(int x, int y) const;
+
+        // 按 key 生成一局雷区，尺寸不同时抛出 invalid_argument
+        static Board fromKey(const BoardKey& key);
+
+        // 在 (px, py) 周围 3x3 之外随机布雷，种子随机并记录在 getKey() 中
+        void generate(int px, int py);
+        // 按 key 中的种子、引擎和首次点击布雷
+        void generate(const BoardKey& key);
+        // 使用调用方提供的引擎布雷，此时 hasKey() 为 false
+        void generate(int px, int py, RandomRef random);
+        bool hasKey() const { return m_has_key; }
+        const BoardKey& getKey() const { return m_key; }
+        // 导入雷的位平面（每行 getStride() 个字），雷数取自位平面
+        void loadMines(std::span<const Word> mines);
+        // 采用后台预生成的布局（已布雷的同尺寸 Board），把 (px, py) 周围 3x3 的雷移走并局部修补雷数
+        // 受影响的开口不再有编号，翻开时退回位平面扩张；找不到可移入的位置时整局重新生成
+        // 采用的布局不能由 BoardKey 复现，此后 hasKey() 为 false（整局重新生成时除外）
+        void adopt(Board&& layout, int px, int py);
+        // 只复制分析需要读取的状态（尺寸、纪元、雷、翻开、旗子和雷数），复用本棋盘已有的缓冲区
+        // 开口、区块统计等不复制，结果只能用于查询，不能再翻开或布雷
+        void snapshot(const Board& source);
+        // 只推进纪元，旧局的数据在行被访问或布雷时才清除，与棋盘大小无关
+        void reset();
+
+        // 翻开单个格子
+        BoardResult uncover(int x, int y);
+        // 从 (x, y) 开始连锁翻开
+        // 以 64 位行字为单位在 "零格" 位平面上反复扩张，直到不再变化，再补上一圈数字格
+        BoardResult reveal(int x, int y);
+
+        // 开口超过该格数时改为分帧翻开，小于 0 表示不分帧
+        void setStreamThreshold(int cells) { m_stream_threshold = cells; }
+        // 棋盘格数达到该值时连锁翻开改用多线程，小于 0 表示只用单线程
+        void setParallelThreshold(int cells) { m_parallel_threshold = cells; }
+        bool isRevealing() const { return m_layer_pos < m_layer.size() || !m_next_layer.empty(); }
+        // 按 BFS 层继续分帧翻开，超出时间预算即返回
+        BoardResult revealStep(std::chrono::microseconds budget);
+
+        // 左键 / 右键的游戏逻辑
+        BoardResult leftClick(int x, int y);
+        // 尚未布雷时先采用预生成的布局，变化记录与布雷合并为一次操作
+        BoardResult leftClick(int x, int y, Board&& layout);
+        BoardResult rightClick(int x, int y);
+        // 双击已翻开的数字格：周围旗数等于雷数时翻开其余邻居
+        // 所有零格邻居合并为一次扩张，最多返回一个结果
+        BoardResult chord(int x, int y);
+
+        // 直接把格子设为 state，只改翻开、旗子和排队位并维护计数与区块统计，不触发连锁翻开
+        // 供撤销/重做使用，未布雷时不做任何事
+        void setState(int x, int y, CellState state);
+        // 把 f 中的多次操作合并为一次变化记录
+        template <typename F>
+        void batch(F&& f) {
+            ChangeScope scope(*this);
+            f();
+        }
+
+        // 各位平面只在 isGenerated() 之后有效，reset 之后可能残留上一局的内容
+        const std::vector<Word>& getMinePlane() const { return m_mines; }
+        const std::vector<Word>& getRevealedPlane() const { return m_revealed; }
+        const std::vector<Word>& getFlagPlane() const { return m_flags; }
+        // 周围没有雷的安全格
+        const std::vector<Word>& getZeroPlane() const { return m_zeros; }
+
+        // 零格连通区域（开口），布雷后立即标记
+        int getOpeningCount() const { return static_cast<int>(m_opening_offsets.size()) - 1; }
+        // (x, y) 所在开口的编号，非零格返回 -1
+        int getOpeningLabel(int x, int y) const;
+        // 开口内的零格及其数字边界，按格子下标存储
+        std::span<const int> getOpening(int label) const {
+            return {m_opening_cells.data() + m_opening_offsets[label], m_opening_cells.data() + m_opening_offsets[label + 1]};
+        }
+
+        // 最近一次 reveal 新翻开的格子，只在 [getRevealFirstRow(), getRevealLastRow()] 行内有效
+        const std::vector<Word>& getRevealDelta() const { return m_region; }
+
+        // 矩形 [x0, x1) x [y0, y1) 内的统计，按两级区块汇总，只有边缘的区块逐字统计
+        BoardStats getStats(int x0, int y0, int x1, int y1) const;
+        BoardStats getStats() const { return getStats(0, 0, m_width, m_height); }
+
+        // 最近一次操作（点击、翻开、分帧、重置）产生的状态变化，按发生顺序排列
+        std::span<const CellChange> getChanges() const { return m_changes; }
+        // 关闭后不再记录，超大开口展开时可省去逐格记录的开销
+        void setRecordChanges(bool enabled) { m_record_changes = enabled; }
+        int getRevealFirstRow() const { return m_delta_first; }
+        int getRevealLastRow() const { return m_delta_last; }
+
+    private:
+        // 最外层操作开始时清空变化记录，嵌套的操作只追加
+        class ChangeScope {
+        public:
+            explicit ChangeScope(Board& board) : board(board) {
+                if (board.m_change_depth++ == 0) board.m_changes.clear();
+            }
+            ~ChangeScope() { --board.m_change_depth; }
+        private:
+            Board& board;
+        };
+        void record(int i, CellState before, CellState after) {
+            if (m_record_changes) m_changes.push_back({i, before, after});
+        }
+        // 把 m_region 中 [m_delta_first, m_delta_last] 行新翻开的格子计入变化记录和区块统计
+        void commitDelta();
+
+        // 区块统计：一级区块为 64x64 格（每行一个字），二级区块为 16x16 个一级区块
+        static constexpr int TILE_SHIFT = 6;
+        static constexpr int BLOCK_SHIFT = 4;
+        BoardStats& tileOf(int x, int y) { return m_tiles[(y >> TILE_SHIFT) * m_tiles_x + (x >> TILE_SHIFT)]; }
+        BoardStats& blockOf(int x, int y) {
+            return m_blocks[(y >> (TILE_SHIFT + BLOCK_SHIFT)) * m_blocks_x + (x >> (TILE_SHIFT + BLOCK_SHIFT))];
+        }
+        // 单格变化同时更新两级区块
+        void tally(int x, int y, int revealed, int flagged, int flag_mines) {
+            for (BoardStats* stats : {&tileOf(x, y), &blockOf(x, y)}) {
+                stats->revealed += revealed;
+                stats->flagged += flagged;
+                stats->flag_mines += flag_mines;
+            }
+        }
+        // 布雷后由位平面重新汇总所有区块
+        void summarize();
+
+        // 行的纪元落后于棋盘纪元时，该行的翻开、旗子和排队状态都视为上一局的残留
+        // 雷、零格和雷数在布雷时整体重写，未布雷时直接视为空
+        bool isStale(int y) const { return m_row_epoch[y] != m_epoch; }
+        // 清空过期的一行并标记为当前纪元
+        void freshen(int y);
+        bool testBit(const std::vector<Word>& plane, int x, int y) const {
+            return (plane[y * m_stride + (x >> 6)] >> (x & 63)) & 1;
+        }
+        void setBit(std::vector<Word>& plane, int x, int y) {
+            plane[y * m_stride + (x >> 6)] |= Word(1) << (x & 63);
+        }
+        void clearBit(std::vector<Word>& plane, int x, int y) {
+            plane[y * m_stride + (x >> 6)] &= ~(Word(1) << (x & 63));
+        }
+        // 可继续扩张的格子：零格中未翻开且未插旗的
+        Word passable(int i) const { return m_zeros[i] & ~m_flags[i] & ~m_revealed[i] & ~m_pending[i]; }
+        // 由雷的位平面重新计算周围雷数和零格平面
+        void updateCounts();
+        void addCount(int x, int y, int delta) {
+            int i = index(x, y);
+            m_counts[i >> 1] = static_cast<uint8_t>(m_counts[i >> 1] + (delta << ((i & 1) * 4)));
+        }
+        // 把安全区内的雷移到远处不接触任何零格的位置，目标由 seed 和点击位置决定；没有这样的位置时返回 false
+        bool clearSafeZone(int px, int py, uint64_t seed);
+        // 并查集标记开口，结果以 CSR 形式保存
+        void labelOpenings();
+        // 直接按预先标记的开口翻开，开口内有旗子或已翻开的零格时返回 false
+        bool revealOpening(int label);
+        void beginStream(int x, int y);
+        void clearDelta();
+        // 连锁翻开时按行划分的条带 [top, bottom)，多线程时每个线程负责一条
+        struct Band {
+            int top, bottom;
+            // 条带内零格区域所在的行范围
+            int first, last;
+            // 相邻条带边缘行的副本，没有相邻条带时为空
+            Word* above;
+            Word* below;
+            Word* scratch;
+            Word* prev;
+            int uncovered;
+        };
+        // 用上下两行及本行扩张第 y 行，返回是否有变化
+        bool growRow(int y, Band& band);
+        // 条带内扩张到不再变化，返回是否有变化
+        bool floodBand(Band& band);
+        // 在条带内补上数字边界并写入翻开平面
+        void borderBand(Band& band);
+        // 从 m_region 中已有的种子扩张，种子位于 [first, last] 行内
+        void floodRegion(int first, int last);
+        void floodRegionParallel(int workers, int first, int last);
+
+        int m_width = 0, m_height = 0, m_count = 0;
+        int m_stride = 0;
+        int m_uncovered = 0, m_flag_mine_count = 0;
+        bool m_generated = false;
+        bool m_has_key = false;
+        BoardKey m_key;
+        uint32_t m_epoch = 0;
+        std::vector<uint32_t> m_row_epoch;
+        std::vector<Word> m_mines;
+        std::vector<Word> m_revealed;
+        std::vector<Word> m_flags;
+        std::vector<Word> m_zeros;
+        std::vector<uint8_t> m_counts;
+        // 每个字之前的零格数，用于把零格映射到 m_zero_labels
+        std::vector<uint32_t> m_zero_rank;
+        std::vector<int> m_zero_labels;
+        std::vector<int> m_opening_offsets = {0};
+        std::vector<int> m_opening_cells;
+        // 最后一个字中有效位的掩码
+        Word m_tail_mask = 0;
+        // 连锁翻开时复用的缓冲区
+        std::vector<Word> m_region;
+        std::vector<Word> m_row_prev;
+        std::vector<Word> m_row_cur;
+        int m_delta_first = 0, m_delta_last = -1;
+        std::vector<BoardStats> m_tiles;
+        std::vector<BoardStats> m_blocks;
+        int m_tiles_x = 0, m_blocks_x = 0;
+        std::vector<CellChange> m_changes;
+        int m_change_depth = 0;
+        bool m_record_changes = true;
+        // 分帧翻开：排队中的格子及当前、下一层 BFS 前沿
+        std::vector<Word> m_pending;
+        std::vector<int> m_layer;
+        std::vector<int> m_next_layer;
+        size_t m_layer_pos = 0;
+        int m_stream_threshold = -1;
+        int m_parallel_threshold = 1 << 22;
+    };
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <Board.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Game {
+    // 无尽模式的雷区：世界按 64x64 的区块惰性生成
+    // 每格是否为雷只由 (世界种子, 坐标) 的哈希决定，所以区块可以随时丢弃并原样重建
+    // 内存超出预算时按 LRU 淘汰区块：未改动的直接丢弃，改动过的把翻开/旗子两张位平面按字游程编码后保留
+    // 压缩后的区块也计入预算，超出时最早淘汰的写入临时文件，内存中每块只剩文件里的位置
+    class ChunkWorld {
+    public:
+        using Word = uint64_t;
+        static constexpr int CHUNK = 64;
+        static constexpr int CHUNK_SHIFT = 6;
+
+        // density 为每格是雷的概率，memory_budget 为常驻区块和内存中压缩区块合计的字节上限
+        ChunkWorld(uint64_t seed, double density, std::size_t memory_budget = std::size_t(64) << 20);
+        ~ChunkWorld();
+        ChunkWorld(ChunkWorld&&) noexcept;
+        ChunkWorld& operator=(ChunkWorld&&) noexcept;
+
+        uint64_t getSeed() const { return m_seed; }
+        double getDensity() const { return m_density; }
+        bool isStarted() const { return m_started; }
+        // 已翻开的安全格总数
+        int64_t getUncovered() const { return m_uncovered; }
+
+        // 常驻内存、在内存中压缩保存、写入临时文件的区块数
+        std::size_t getChunkCount() const { return m_chunks.size(); }
+        std::size_t getColdCount() const { return m_cold.size(); }
+        std::size_t getSpilledCount() const { return m_spilled.size(); }
+        std::size_t getMaxChunks() const { return m_max_chunks; }
+        // 计入预算的字节数
+        std::size_t getMemoryUsage() const { return m_chunks.size() * sizeof(Chunk) + m_cold_bytes; }
+
+        // 只由哈希判断，不加载区块
+        bool isMine(int64_t x, int64_t y) const;
+
+        bool isRevealed(int64_t x, int64_t y);
+        bool isFlagged(int64_t x, int64_t y);
+        int getMineCount(int64_t x, int64_t y);
+        CellState getState(int64_t x, int64_t y);
+        // 只读取已加载的区块，未加载时返回 false；绘制前先用 visit 加载可见区域
+        bool peek(int64_t x, int64_t y, CellState& state, int& mines) const;
+
+        // 首次点击保证周围 3x3 无雷
+        BoardResult leftClick(int64_t x, int64_t y);
+        void rightClick(int64_t x, int64_t y);
+
+        // 单次翻开最多处理的格数，超出的部分留在队列里由 revealStep 继续
+        void setRevealLimit(int64_t limit) { m_reveal_limit = limit; }
+        bool isRevealing() const { return !m_frontier.empty(); }
+        void revealStep(int64_t max_cells);
+
+        // 镜头到达的区域，闭区间，按区块加载以便绘制
+        void visit(int64_t left, int64_t top, int64_t right, int64_t bottom);
+
+        // 清空所有进度，保留种子
+        void reset();
+    private:
+        struct Chunk {
+            std::array<Word, CHUNK> mines{};
+            std::array<Word, CHUNK> revealed{};
+            std::array<Word, CHUNK> flags{};
+            // 每格一个字节的周围雷数
+            std::array<uint8_t, CHUNK * CHUNK> counts{};
+            // 翻开过或插过旗，淘汰时需要保存
+            bool dirty = false;
+            std::list<uint64_t>::iterator lru;
+        };
+        // 被淘汰的已改动区块，stamp 用于在 m_cold_order 中识别过期的记录
+        struct ColdChunk {
+            std::vector<uint8_t> data;
+            uint64_t stamp;
+        };
+        // 写入临时文件的区块
+        struct SpilledChunk {
+            int64_t offset;
+            uint32_t size;
+        };
+        struct SpillFile;
+
+        static uint64_t chunkKey(int64_t cx, int64_t cy) {
+            return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+        }
+
+        // 取得区块，不存在则生成；不会触发淘汰，指针在下一次 trim 之前有效
+        Chunk& chunk(int64_t cx, int64_t cy);
+        Chunk& chunkAt(int64_t x, int64_t y) { return chunk(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT); }
+        void build(Chunk& chunk, int64_t cx, int64_t cy) const;
+        // 把最久未使用的区块淘汰到预算以内
+        void trim();
+        // 把最早淘汰的压缩区块写入临时文件，直到内存中的压缩区块回到预算以内
+        void spill();
+        // 取出已淘汰区块的翻开/旗子位平面，没有时返回 false
+        bool restore(uint64_t key, Chunk& chunk);
+
+        void flood();
+
+        uint64_t m_seed;
+        double m_density;
+        uint64_t m_threshold;
+        std::size_t m_max_chunks;
+        std::size_t m_cold_budget;
+        std::size_t m_cold_bytes = 0;
+        bool m_started = false;
+        int64_t m_safe_x = 0, m_safe_y = 0;
+        int64_t m_uncovered = 0;
+        int64_t m_reveal_limit = int64_t(1) << 20;
+
+        std::unordered_map<uint64_t, std::unique_ptr<Chunk>> m_chunks;
+        std::unordered_map<uint64_t, ColdChunk> m_cold;
+        // 按淘汰先后排列，区块重新加载后留下的记录在写出时跳过
+        std::deque<std::pair<uint64_t, uint64_t>> m_cold_order;
+        uint64_t m_cold_stamp = 0;
+        std::unordered_map<uint64_t, SpilledChunk> m_spilled;
+        // 第一次需要写出时才创建
+        std::unique_ptr<SpillFile> m_spill;
+        // 最近使用的在前
+        std::list<uint64_t> m_lru;
+        std::deque<std::pair<int64_t, int64_t>> m_frontier;
+    };
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <Board.hpp>
+#include <HintEngine.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Game {
+    enum class Solvability : uint8_t {
+        // 未给出首次点击，没有判断
+        Unknown,
+        // 只靠 Solver 的推理（加上总雷数）就能翻完
+        NoGuess,
+        NeedsGuess,
+    };
+
+    struct BoardDifficulty {
+        // 不插旗时翻完所需的最少点击数：每个开口一次，加上不与开口相邻的数字格各一次
+        int bbbv = 0;
+        int openings = 0;
+        // 不与开口相邻的数字格按 8 邻接连成的块
+        int islands = 0;
+        // 已翻开部分对应的 3BV：翻开过的开口和翻开的孤立数字格
+        int solved_bbbv = 0;
+        Solvability solvability = Solvability::Unknown;
+        // 从首次点击出发不猜时能翻开的格子数
+        int solved_cells = 0;
+    };
+
+    // 一局结束时的统计，随 GameWin / GameOver 消息发出
+    struct GameSummary {
+        int bbbv = 0;
+        int solved_bbbv = 0;
+        double seconds = 0;
+
+        double getBBBVPerSecond() const { return seconds > 0 ? solved_bbbv / seconds : 0; }
+    };
+
+    // 由雷和零格的位平面统计 3BV、开口和孤岛，不做洪水填充：
+    // 相邻关系用整字移位得到，连通块按行内的连续段做并查集，每段只与上一行重叠的段合并
+    // 内部的缓冲区在多次调用之间复用，批量筛选时每个线程持有一个分析器即可
+    class DifficultyAnalyser {
+    public:
+        // 只有雷的位平面（每行 stride 个字）时使用，零格由雷平面推出
+        BoardDifficulty analyse(const uint64_t* mines, int width, int height, int stride);
+        // 已布雷的棋盘，直接使用布雷时算好的零格，并统计已翻开部分的 3BV
+        BoardDifficulty analyse(const Board& board);
+        // 另外从 (px, py) 开始模拟只翻开可证明安全的格子，判断能否不猜解开
+        BoardDifficulty analyse(const Board& board, int px, int py);
+
+    private:
+        struct Run {
+            int x0, x1;
+        };
+
+        // zeros 已在 m_zeros 中，revealed 可为空
+        BoardDifficulty count(const uint64_t* mines, const uint64_t* revealed);
+        // 把 plane 中每行的连续段写入 m_runs / m_row_runs，返回 8 邻接连通块数
+        // revealed 非空时 solved 返回含有已翻开格子的连通块数
+        int components(const std::vector<uint64_t>& plane, const uint64_t* revealed, int& solved);
+        // out = plane 的 3x3 膨胀
+        void dilate(const uint64_t* plane, std::vector<uint64_t>& out);
+
+        // 每行第 k 个字中落在棋盘内的位
+        uint64_t validBits(int k) const {
+            const int bits = m_width - k * 64;
+            return bits >= 64 ? ~uint64_t(0) : bits > 0 ? (uint64_t(1) << bits) - 1 : 0;
+        }
+
+        int m_width = 0, m_height = 0, m_stride = 0;
+        std::vector<uint64_t> m_zeros;
+        std::vector<uint64_t> m_near;
+        std::vector<uint64_t> m_isolated;
+        std::vector<uint64_t> m_row;
+        std::vector<Run> m_runs;
+        std::vector<int> m_row_runs;
+        std::vector<int> m_parent;
+        std::vector<uint8_t> m_solved;
+        // 模拟对局用的棋盘，尺寸或雷数变化时重建
+        std::unique_ptr<Board> m_play;
+        std::unique_ptr<HintEngine> m_hints;
+    };
+}
@@ -0,0 +1,312 @@
+#pragma once
+
+#include <Board.hpp>
+#include <Random.hpp>
+#include <Topology.hpp>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <variant>
+
+namespace Game {
+    // 尺寸和雷数在编译期确定的雷区，用于标准难度
+    // 每行恰好一个 64 位字，边界掩码和邻居表都是常量，循环次数固定，编译器可以完全展开
+    // 布雷顺序与 Board 一致，同一个 BoardKey 得到相同的雷区
+    template <int W, int H, int Mines>
+    class FixedBoard {
+        static_assert(W > 0 && W <= 64 && H > 0, "Each row must fit in one 64-bit word");
+        static_assert(Mines > 0 && Mines <= W * H - 9, "Invalid mine count");
+    public:
+        using Word = uint64_t;
+        static constexpr int WIDTH = W;
+        static constexpr int HEIGHT = H;
+        static constexpr int MINES = Mines;
+        static constexpr Word ROW_MASK = W == 64 ? ~Word(0) : (Word(1) << W) - 1;
+        // 八邻域偏移，与方形拓扑共用一张表
+        static constexpr std::array<Topology::Offset, 8> NEIGHBOURS = Topology::Square8::ROW;
+
+        FixedBoard() { reset(); }
+
+        static constexpr int getWidth() { return W; }
+        static constexpr int getHeight() { return H; }
+        static constexpr int getCount() { return Mines; }
+        static constexpr bool contains(int x, int y) { return x >= 0 && x < W && y >= 0 && y < H; }
+        static constexpr int index(int x, int y) { return y * W + x; }
+
+        int getUncovered() const { return m_uncovered; }
+        int getFlagMineCount() const { return m_flag_mine_count; }
+        bool isGenerated() const { return m_generated; }
+        bool hasKey() const { return m_has_key; }
+        const BoardKey& getKey() const { return m_key; }
+
+        bool isMine(int x, int y) const { return (m_mines[y] >> x) & 1; }
+        bool isRevealed(int x, int y) const { return (m_revealed[y] >> x) & 1; }
+        bool isFlagged(int x, int y) const { return (m_flags[y] >> x) & 1; }
+        int getMineCount(int x, int y) const { return m_counts[index(x, y)]; }
+        CellState getState(int x, int y) const {
+            if (isRevealed(x, y)) {
+                return CellState::Uncovered;
+            } else if (isFlagged(x, y)) {
+                return CellState::Flag;
+            }
+            return m_generated ? CellState::Default : CellState::Empty;
+        }
+
+        const std::array<Word, H>& getMinePlane() const { return m_mines; }
+        const std::array<Word, H>& getRevealedPlane() const { return m_revealed; }
+        const std::array<Word, H>& getFlagPlane() const { return m_flags; }
+
+        void generate(int px, int py) {
+            static thread_local SplitMix64 seeds(
+                (uint64_t(std::random_device{}()) << 32) ^ std::random_device{}());
+            generate(BoardKey{seeds(), W, H, Mines, px, py, RandomKind::Xoshiro256});
+        }
+
+        void generate(const BoardKey& key) {
+            if (key.width != W || key.height != H || key.count != Mines) {
+                throw std::invalid_argument("Board key does not match board size");
+            }
+            switch (key.engine) {
+                case RandomKind::SplitMix64: {
+                    SplitMix64 engine(key.seed);
+                    generate(key.x, key.y, engine);
+                    break;
+                }
+                case RandomKind::Xoshiro256: {
+                    Xoshiro256 engine(key.seed);
+                    generate(key.x, key.y, engine);
+                    break;
+                }
+                case RandomKind::Pcg64: {
+                    Pcg64 engine(key.seed);
+                    generate(key.x, key.y, engine);
+                    break;
+                }
+            }
+            m_key = key;
+            m_has_key = true;
+        }
+
+        void generate(int px, int py, RandomRef random) {
+            m_mines.fill(0);
+            // 与 Board 相同：安全区之外的格子按行优先编号，Floyd 抽样
+            const int sx0 = std::max(px - 1, 0), sx1 = std::min(px + 1, W - 1);
+            const int sy0 = std::max(py - 1, 0), sy1 = std::min(py + 1, H - 1);
+            const int sw = sx1 - sx0 + 1;
+            const int before = sy0 * W;
+            const int band = (sy1 - sy0 + 1) * (W - sw);
+            const int n = W * H - sw * (sy1 - sy0 + 1);
+            auto cell_of = [=](int r) {
+                if (r < before) {
+                    return r;
+                }
+                r -= before;
+                if (r < band) {
+                    int c = r % (W - sw);
+                    return (sy0 + r / (W - sw)) * W + (c < sx0 ? c : c + sw);
+                }
+                return (sy1 + 1) * W + (r - band);
+            };
+            for (int j = n - Mines; j < n; ++j) {
+                int i = cell_of(static_cast<int>(random.below(j + 1)));
+                if ((m_mines[i / W] >> (i % W)) & 1) {
+                    i = cell_of(j);
+                }
+                m_mines[i / W] |= Word(1) << (i % W);
+            }
+            updateCounts();
+            m_generated = true;
+            m_has_key = false;
+            m_flag_mine_count = 0;
+            for (int y = 0; y < H; ++y) {
+                m_flag_mine_count += std::popcount(m_flags[y] & m_mines[y]);
+            }
+        }
+
+        void reset() {
+            m_mines.fill(0);
+            m_revealed.fill(0);
+            m_flags.fill(0);
+            m_zeros.fill(0);
+            m_counts.fill(0);
+            m_uncovered = W * H - Mines;
+            m_flag_mine_count = 0;
+            m_generated = false;
+            m_has_key = false;
+        }
+
+        BoardResult leftClick(int x, int y) {
+            if (isFlagged(x, y) || isRevealed(x, y)) {
+                return BoardResult::None;
+            }
+            if (!m_generated) {
+                generate(x, y);
+            }
+            if (isMine(x, y)) {
+                m_revealed[y] |= Word(1) << x;
+                return BoardResult::Lose;
+            }
+            Region seed{};
+            seed[y] = Word(1) << x;
+            if (getMineCount(x, y) > 0) {
+                reveal(seed);
+            } else {
+                flood(seed);
+            }
+            return m_uncovered == 0 ? BoardResult::Win : BoardResult::None;
+        }
+
+        BoardResult rightClick(int x, int y) {
+            if (isRevealed(x, y)) {
+                return BoardResult::None;
+            }
+            const Word bit = Word(1) << x;
+            const int on_mine = m_generated && isMine(x, y);
+            m_flags[y] ^= bit;
+            if (!(m_flags[y] & bit)) {
+                m_flag_mine_count -= on_mine;
+                return BoardResult::None;
+            }
+            m_flag_mine_count += on_mine;
+            return m_flag_mine_count == Mines ? BoardResult::Win : BoardResult::None;
+        }
+
+        // 周围旗数等于雷数时翻开其余邻居，零格邻居合并为一次扩张
+        BoardResult chord(int px, int py) {
+            if (!m_generated || !contains(px, py) || !isRevealed(px, py) || isMine(px, py)) {
+                return BoardResult::None;
+            }
+            int flags = 0;
+            for (auto [dx, dy, dz] : NEIGHBOURS) {
+                flags += contains(px + dx, py + dy) && isFlagged(px + dx, py + dy);
+            }
+            if (flags == 0 || flags != getMineCount(px, py)) {
+                return BoardResult::None;
+            }
+            Region zeros{}, others{};
+            for (int y = std::max(py - 1, 0); y <= std::min(py + 1, H - 1); ++y) {
+                const Word around = spread(Word(1) << px) & ~m_flags[y] & ~m_revealed[y];
+                zeros[y] = around & m_zeros[y];
+                others[y] = around & ~m_zeros[y];
+            }
+            flood(zeros);
+            bool lost = false;
+            for (int y = 0; y < H; ++y) {
+                // 踩到的雷只标记为翻开，不计入剩余安全格
+                const Word mines = others[y] & m_mines[y];
+                m_revealed[y] |= mines;
+                lost |= mines != 0;
+                others[y] &= ~m_mines[y] & ~m_revealed[y];
+            }
+            reveal(others);
+            if (lost) {
+                return BoardResult::Lose;
+            }
+            return m_uncovered == 0 ? BoardResult::Win : BoardResult::None;
+        }
+    private:
+        using Region = std::array<Word, H>;
+
+        // 行内左右各扩一格
+        static constexpr Word spread(Word row) {
+            return (row | (row << 1) | (row >> 1)) & ROW_MASK;
+        }
+
+        // 位切片加法：8 个邻居位向量逐位相加成 4 位计数
+        void updateCounts() {
+            for (int y = 0; y < H; ++y) {
+                const Word up = y > 0 ? m_mines[y - 1] : 0;
+                const Word mid = m_mines[y];
+                const Word down = y + 1 < H ? m_mines[y + 1] : 0;
+                const Word inputs[8] = {
+                    (up << 1) & ROW_MASK, up, up >> 1,
+                    (mid << 1) & ROW_MASK, mid >> 1,
+                    (down << 1) & ROW_MASK, down, down >> 1,
+                };
+                Word s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+                for (Word in : inputs) {
+                    Word c0 = s0 & in;
+                    s0 ^= in;
+                    Word c1 = s1 & c0;
+                    s1 ^= c0;
+                    Word c2 = s2 & c1;
+                    s2 ^= c1;
+                    s3 |= c2;
+                }
+                m_zeros[y] = ~(s0 | s1 | s2 | s3) & ~mid & ROW_MASK;
+                for (int x = 0; x < W; ++x) {
+                    m_counts[index(x, y)] = static_cast<uint8_t>(
+                        ((s0 >> x) & 1) | (((s1 >> x) & 1) << 1) | (((s2 >> x) & 1) << 2) | (((s3 >> x) & 1) << 3));
+                }
+            }
+        }
+
+        // 翻开 cells 中尚未翻开的格子
+        void reveal(const Region& cells) {
+            for (int y = 0; y < H; ++y) {
+                const Word add = cells[y] & ~m_revealed[y];
+                m_revealed[y] |= add;
+                m_uncovered -= std::popcount(add);
+            }
+        }
+
+        // 从零格种子出发在零格平面上扩张到不再变化，再补上一圈数字格
+        void flood(Region region) {
+            Region passable;
+            for (int y = 0; y < H; ++y) {
+                passable[y] = m_zeros[y] & ~m_flags[y] & ~m_revealed[y];
+                region[y] &= passable[y];
+            }
+            bool changed = true;
+            while (changed) {
+                changed = false;
+                for (int y = 0; y < H; ++y) {
+                    Word grown = spread(region[y]);
+                    if (y > 0) grown |= spread(region[y - 1]);
+                    if (y + 1 < H) grown |= spread(region[y + 1]);
+                    grown &= passable[y];
+                    // 行内连续的零格一次填满
+                    while (true) {
+                        Word next = spread(grown) & passable[y];
+                        if (next == grown) break;
+                        grown = next;
+                    }
+                    if (grown != region[y]) {
+                        region[y] = grown;
+                        changed = true;
+                    }
+                }
+            }
+            Region border{};
+            for (int y = 0; y < H; ++y) {
+                Word around = spread(region[y]);
+                if (y > 0) around |= spread(region[y - 1]);
+                if (y + 1 < H) around |= spread(region[y + 1]);
+                border[y] = around & ~m_mines[y] & ~m_flags[y];
+            }
+            reveal(border);
+        }
+
+        std::array<Word, H> m_mines{};
+        std::array<Word, H> m_revealed{};
+        std::array<Word, H> m_flags{};
+        std::array<Word, H> m_zeros{};
+        std::array<uint8_t, W * H> m_counts{};
+        int m_uncovered = 0, m_flag_mine_count = 0;
+        bool m_generated = false;
+        bool m_has_key = false;
+        BoardKey m_key;
+    };
+
+    // 标准难度，尺寸与 main.cpp 中的参数一致（宽、高、雷数）
+    using BeginnerBoard = FixedBoard<9, 9, 10>;
+    using IntermediateBoard = FixedBoard<16, 16, 40>;
+    using ExpertBoard = FixedBoard<16, 30, 99>;
+
+    // 标准难度使用编译期特化的棋盘，其他尺寸退回运行时的 Board
+    using AnyBoard = std::variant<BeginnerBoard, IntermediateBoard, ExpertBoard, Board>;
+    AnyBoard make_board(int w, int h, int count);
+}
@@ -10,15 +10,28 @@
 #include <SFML/Graphics/VertexArray.hpp>
 #include <SFML/System/Clock.hpp>
 #include <Singleton.hpp>
+#include <AnalysisWorker.hpp>
+#include <Board.hpp>
+#include <ChunkWorld.hpp>
+#include <GridBoard.hpp>
+#include <Difficulty.hpp>
+#include <Journal.hpp>
+#include <LayoutPool.hpp>
+#include <NoGuess.hpp>
 #include <IDGenerator.hpp>
 #include <SFML/Graphics/Drawable.hpp>
 #include <SFML/Graphics/Rect.hpp>
+#include <chrono>
 #include <cstdio>
 #include <functional>
+#include <future>
 #include <memory>
+#include <optional>
 #include <stdexcept>
+#include <stop_token>
 #include <vector>
 #include <typeindex>
+#include <variant>
 
 namespace Base {
     class MessageBase {
@@ -38,6 +51,8 @@ namespace Base {
         public:
             virtual BoundsPtr getBounds() const = 0;
             virtual IDCode getCode() const = 0;
+            // 控件内可区分的点击目标，两次按下落在不同目标上时不构成双击；默认整个控件是一个目标
+            virtual sf::Vector2i getClickTarget(sf::Vector2i position) const { return {0, 0}; }
 
             virtual ~ControlBase() = default;
 
@@ -48,85 +63,103 @@ namespace Base {
 
 namespace Game {
     struct Cells;
-    class Cell: public Base::Control::ControlBase, public sf::Drawable, public sf::Transformable {
+    // 单个格子的轻量视图，状态全部保存在 Board 中
+    class Cell {
     public:
-        int m_mine_count = 0;
-        bool m_is_mine = false;
-        enum class CellState {
-            // 没有点击，暨没有初始化雷的情况
-            Empty,
-            // 标记为雷
-            Mine,
-            // 标记为旗
-            Flag,
-            // 默认（雷区已经初始）
-            Default,
-            // 已经被打开
-            Uncovered,
-        };
-
-        CellState state = CellState::Empty;
-
-        Cell(const sf::Rect<int>& rect, sf::Font& font, int x, int y, Cells& parent);
-        const int getMineCount() const { return m_mine_count; }
-
-        Base::Control::BoundsPtr getBounds() const override;
-
-        IDCode getCode() const override;
-
-        void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
-
-        void reset() {
-            update(CellState::Empty);
-            m_mine_count = 0;
-        }
+        using CellState = Game::CellState;
 
-        void update(CellState state);
+        Cell(Cells& parent, int x, int y) : parent(parent), x(x), y(y) {}
 
-        void updateMineText();
+        int getMineCount() const;
+        bool isMine() const;
+        CellState getState() const;
 
-        void OnClicked(std::shared_ptr<const Base::MessageBase> message) override;
-
-        bool isMine() const { return m_is_mine; }
-        void setMine(bool is_mine) { m_is_mine = is_mine; }
-        void addMineCount() { ++m_mine_count; }
+        void OnClicked(std::shared_ptr<const Base::MessageBase> message);
     private:
-        std::shared_ptr<const sf::Rect<int>> m_rect;
-        ID m_id;
-        sf::VertexArray vertices;
-        int border;
-        sf::Sprite m_sprite_mine;
-        sf::Sprite m_sprite_flag;
-        sf::Text m_mine_count_text;
-        int x, y;
         Cells& parent;
+        int x, y;
     };
 
     struct Cells {
-        int width, height, count, uncovered, flag_mine_count;
-        std::vector<Cell> _cells;
-        Cells() = default;
-        Cells(int w, int h, sf::Rect<int> rect, int count);
-        Cell& operator()(int x, int y) {
+        int width, height, count;
+        Board board;
+        // 后台预生成的布局，首次点击时直接采用
+        LayoutPool pool;
+        // 每次点击（含其后的分帧翻开）为一条撤销记录
+        Journal journal;
+        // 首次点击时在后台生成不需要猜的雷区，渲染线程每帧只检查一次是否完成
+        // 超过 no_guess_options.timeout 仍未找到则退回预生成的布局
+        bool no_guess = false;
+        NoGuessOptions no_guess_options;
+        std::future<std::optional<Board>> no_guess_job;
+        std::stop_source no_guess_stop;
+        // 已请求停止、尚未结束的后台布雷，结束后在 update 中丢弃，重置时不必等待
+        std::vector<std::future<std::optional<Board>>> no_guess_abandoned;
+        // 等待后台布雷的首次点击
+        int pending_x = 0, pending_y = 0;
+        // 对局结束时统计 3BV
+        DifficultyAnalyser analyser;
+        // 首次点击的时刻，用于计算 3BV/s
+        std::chrono::steady_clock::time_point started;
+        // 每次改变棋盘的操作加一，后台分析据此判断结果是否过期
+        uint64_t version = 0;
+        Cells(int w, int h, int count);
+        // 放弃进行中的后台布雷，析构时只等它停下而不是等它找完
+        ~Cells() { no_guess_stop.request_stop(); }
+        Cell operator()(int x, int y) {
             if (x < 0 || x >= width || y < 0 || y >= height) {
                 throw std::out_of_range("Cell coordinates out of range");
             }
-            return _cells[y * width + x];
+            return Cell(*this, x, y);
         }
 
-        using iterator = std::vector<Cell>::iterator;
-        using const_iterator = std::vector<Cell>::const_iterator;
-        iterator begin() { return _cells.begin(); }
-        iterator end() { return _cells.end(); }
-        const_iterator begin() const { return _cells.begin(); }
+        int getUncovered() const { return board.getUncovered(); }
+        int getFlagMineCount() const { return board.getFlagMineCount(); }
+        // 任意矩形内的统计，供 HUD、小地图等使用
+        BoardStats getStats(int x0, int y0, int x1, int y1) const { return board.getStats(x0, y0, x1, y1); }
+        // 最近一次点击、翻开或重置产生的格子变化
+        std::span<const CellChange> getChanges() const { return board.getChanges(); }
 
         void reset() {
-            uncovered = width * height - count;
-            for(auto& cell: _cells) cell.reset();
-            flag_mine_count = 0;
+            version += 1;
+            cancelNoGuess();
+            board.reset();
+            journal.clear();
+            pool.refill();
         }
 
+        bool undo() {
+            if (!journal.undo(board)) return false;
+            version += 1;
+            return true;
+        }
+        bool redo() {
+            if (!journal.redo(board)) return false;
+            version += 1;
+            return true;
+        }
+
+        // 首次点击时优先采用预生成的布局，开启 no_guess 时改为在后台生成免猜布局，完成后由 update 执行这次点击
+        void leftClick(int x, int y);
+        // 每帧调用，后台布雷完成或超时后执行等待中的首次点击
+        void update();
+        bool isGenerating() const { return no_guess_job.valid(); }
+        void cancelNoGuess();
         void reveal(int x, int y);
+        void chord(int x, int y) { dispatch(board.chord(x, y)); }
+
+        // 记入撤销日志，并把 Board 的结果转换为消息广播
+        void dispatch(BoardResult result);
+    };
+
+    // 经典棋盘之外的拓扑，由 GridBoard 实现
+    enum class BoardVariant : uint8_t {
+        Classic,
+        // 奇数行右移半格
+        Hex,
+        Torus,
+        // 一次显示一层
+        Cube,
     };
 
     class CellCoord: public Base::Control::ControlBase, public sf::Drawable {
@@ -139,12 +172,94 @@ namespace Game {
         Base::Control::BoundsPtr getBounds() const override { return m_rect; }
 
         IDCode getCode() const override { return m_id.getCode(); }
-        
+
+        // 每个格子是一个点击目标
+        sf::Vector2i getClickTarget(sf::Vector2i position) const override { return cellAt(position); }
+
+        // 根据点击位置转发给对应的格子，左键双击为一次整体的 chord 操作
+        void OnClicked(std::shared_ptr<const Base::MessageBase> message) override;
+
+        // 在时间预算内推进分帧翻开，每帧调用一次
+        void update(sf::Time budget);
+
+        // 只为视口内的格子生成顶点
         void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
 
-        void reset() { m_cells.reset(); }
+        void reset();
+        // 无尽模式和拓扑变体没有撤销记录
+        void undo() { if (usesCells()) m_cells.undo(); }
+        void redo() { if (usesCells()) m_cells.redo(); }
+
+        // 免猜模式在下一次首次点击时生效
+        void setNoGuess(bool enabled) { m_cells.no_guess = enabled; }
+        bool isNoGuess() const { return m_cells.no_guess; }
+
+        // 叠加层在后台线程中计算，绘制时只读取最近完成的结果
+        void setOverlay(OverlayMode mode);
+        OverlayMode getOverlay() const { return m_overlay; }
+        // 依次切换 关闭 -> 安全格/雷标记 -> 概率
+        void cycleOverlay();
+
+        // 无尽模式：同一块区域作为窗口显示一个 ChunkWorld，雷的密度与当前难度相同，重开时换一个种子
+        // 不支持双击、叠加层和免猜布雷
+        void setEndless(bool enabled);
+        bool isEndless() const { return m_world != nullptr; }
+        // 按格移动镜头
+        void pan(int dx, int dy);
+
+        // 拓扑变体与经典棋盘同尺寸、同密度，三维棋盘有 CUBE_DEPTH 层；与无尽模式互斥
+        // 不支持撤销、叠加层和免猜布雷
+        void setVariant(BoardVariant variant);
+        BoardVariant getVariant() const { return static_cast<BoardVariant>(m_grid.index()); }
+        // 依次切换 经典 -> 六边形 -> 环面 -> 三维
+        void cycleVariant();
+        // 三维棋盘切换显示的层
+        void stepLayer(int dz);
+        int getLayer() const { return m_layer; }
+        static constexpr int CUBE_DEPTH = 4;
     private: 
+        bool usesCells() const { return !m_world && getVariant() == BoardVariant::Classic; }
+        // 位置所在的格子，可能在棋盘外；六边形的奇数行右移半格
+        sf::Vector2i cellAt(sf::Vector2i position) const;
+        // 六边形棋盘的格子略窄，使右移的行不超出区域
+        sf::Vector2f gridCellSize() const;
+
+        void newWorld();
+        void onWorldClicked(std::shared_ptr<const Base::MessageBase> message);
+        void drawWorld(sf::RenderTarget& target, sf::RenderStates states, int x0, int y0, int x1, int y1) const;
+        void newGrid(BoardVariant variant);
+        void onGridClicked(std::shared_ptr<const Base::MessageBase> message);
+        void drawGrid(sf::RenderTarget& target, sf::RenderStates states, int y0, int y1) const;
+
         ID m_id;
+        sf::Vector2i m_cell_size;
+        int border;
+        sf::Sprite m_sprite_mine;
+        sf::Sprite m_sprite_flag;
+        // 数字 1-26，三维棋盘最多有 26 个邻居
+        std::vector<sf::Text> m_mine_count_texts;
+        mutable sf::VertexArray m_vertices;
+
+        AnalysisWorker m_analysis;
+        OverlayMode m_overlay = OverlayMode::None;
+        // 已提交分析的棋盘版本，切换模式后需要重新提交
+        uint64_t m_analysed_version = 0;
+        bool m_overlay_stale = false;
+        mutable sf::VertexArray m_overlay_vertices;
+
+        std::unique_ptr<ChunkWorld> m_world;
+        // 窗口左上角格子的世界坐标
+        int64_t m_camera_x = 0, m_camera_y = 0;
+        // 踩雷后不再响应点击，直到重开
+        bool m_world_lost = false;
+        std::chrono::steady_clock::time_point m_world_started;
+
+        // 下标与 BoardVariant 一一对应
+        std::variant<std::monostate, HexBoard, TorusBoard, CubeBoard> m_grid;
+        int m_layer = 0;
+        // 对局结束后不再响应点击，直到重开
+        bool m_grid_over = false;
+        std::chrono::steady_clock::time_point m_grid_started;
     };
 
     class GameButton: public Base::Control::ControlBase, public sf::Drawable, public sf::Transformable {
@@ -209,11 +324,19 @@ namespace Game {
 namespace Message {
     class GameOver : public Base::MessageBase {
     public:
+        GameOver() = default;
+        explicit GameOver(const Game::GameSummary& summary) : summary(summary) {}
+        Game::GameSummary summary;
+
         std::type_index getTypeIndex() const override { return typeid(GameOver); }
     };
 
     class GameWin : public Base::MessageBase {
     public:
+        GameWin() = default;
+        explicit GameWin(const Game::GameSummary& summary) : summary(summary) {}
+        Game::GameSummary summary;
+
         std::type_index getTypeIndex() const override { return typeid(GameWin); }
     };
 
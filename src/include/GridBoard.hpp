@@ -0,0 +1,82 @@
+#pragma once
+
+#include <Board.hpp>
+#include <Random.hpp>
+#include <Topology.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace Game {
+    // 拓扑由模板参数决定的雷区，邻居来自策略中的常量偏移表，内层循环没有虚调用
+    // 经典方形棋盘仍使用按位平面实现的 Board；这里每格一个字节，适用于六边形、环面和三维等变体
+    // 已显式实例化 Hex6、Torus8、Cube26，由 CellCoord 的拓扑变体使用；Square8 的偏移表由 Board 的逐格循环使用
+    template <typename Topology>
+    class GridBoard {
+    public:
+        // 二维拓扑的 depth 必须为 1，环面每维至少 3 格（邻居互不重复），尺寸或雷数无效时抛出 invalid_argument
+        GridBoard(int w, int h, int d, int count);
+
+        int getWidth() const { return m_width; }
+        int getHeight() const { return m_height; }
+        int getDepth() const { return m_depth; }
+        int getCount() const { return m_count; }
+        int getUncovered() const { return m_uncovered; }
+        int getFlagMineCount() const { return m_flag_mine_count; }
+        bool isGenerated() const { return m_generated; }
+
+        bool contains(int x, int y, int z = 0) const {
+            return x >= 0 && x < m_width && y >= 0 && y < m_height && z >= 0 && z < m_depth;
+        }
+        int index(int x, int y, int z = 0) const { return (z * m_height + y) * m_width + x; }
+
+        bool isMine(int x, int y, int z = 0) const { return m_cells[index(x, y, z)] & MINE; }
+        bool isRevealed(int x, int y, int z = 0) const { return m_cells[index(x, y, z)] & REVEALED; }
+        bool isFlagged(int x, int y, int z = 0) const { return m_cells[index(x, y, z)] & FLAG; }
+        int getMineCount(int x, int y, int z = 0) const { return m_counts[index(x, y, z)]; }
+        CellState getState(int x, int y, int z = 0) const;
+
+        // 点击格及其所有邻居之外随机布雷
+        void generate(int px, int py, int pz, RandomRef random);
+        void reset();
+
+        BoardResult leftClick(int x, int y, int z = 0);
+        BoardResult rightClick(int x, int y, int z = 0);
+        BoardResult chord(int x, int y, int z = 0);
+
+        // 对格子 i 的每个邻居下标调用 f
+        template <typename F>
+        void forEachNeighbour(int i, F&& f) const {
+            const int x = i % m_width;
+            const int y = (i / m_width) % m_height;
+            const int z = i / (m_width * m_height);
+            for (const auto& o : Topology::OFFSETS[y & 1]) {
+                int nx = x + o.dx, ny = y + o.dy, nz = z + o.dz;
+                if constexpr (Topology::WRAP) {
+                    nx = (nx + m_width) % m_width;
+                    ny = (ny + m_height) % m_height;
+                } else if (!contains(nx, ny, nz)) {
+                    continue;
+                }
+                f(index(nx, ny, nz));
+            }
+        }
+    private:
+        static constexpr uint8_t MINE = 1;
+        static constexpr uint8_t REVEALED = 2;
+        static constexpr uint8_t FLAG = 4;
+
+        // 从零格 i 开始连锁翻开
+        void flood(int i);
+
+        int m_width, m_height, m_depth, m_count;
+        int m_uncovered = 0, m_flag_mine_count = 0;
+        bool m_generated = false;
+        std::vector<uint8_t> m_cells;
+        std::vector<uint8_t> m_counts;
+        std::vector<int> m_stack;
+    };
+
+    using HexBoard = GridBoard<Topology::Hex6>;
+    using TorusBoard = GridBoard<Topology::Torus8>;
+    using CubeBoard = GridBoard<Topology::Cube26>;
+}
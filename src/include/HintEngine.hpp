@@ -0,0 +1,44 @@
+#pragma once
+
+#include <Board.hpp>
+#include <Solver.hpp>
+#include <span>
+#include <vector>
+
+namespace Game {
+    // 跟随棋盘变化记录增量维护的提示服务
+    // 翻开只把新格子加入 Solver 并处理受影响的约束；撤销翻开时只清除与这些格子相连的区域再重新推理；
+    // 重置或布雷才整盘重建。每次更新（包括整盘重建）的推理步数可以限制，余下的留到之后的 settle 继续
+    class HintEngine {
+    public:
+        explicit HintEngine(const Board& board) : m_board(board) {}
+
+        // 读取棋盘最近一次操作的变化记录，每次操作后调用一次；棋盘需开启变化记录
+        // max_steps 为本次最多处理的约束条数，小于 0 表示推理到底
+        void update(int max_steps = -1);
+        // 继续推理尚未处理的约束，全部处理完时返回 true
+        bool settle(int max_steps = -1);
+        bool isSettled() const { return m_settled; }
+
+        // 一个可证明安全的未翻开格子，没有时返回 -1
+        int nextSafe();
+        // 所有可证明是雷的未翻开格子
+        std::span<const int> getMines();
+        bool isSafe(int x, int y) const { return !m_board.isRevealed(x, y) && m_solver.get(x, y) == Solver::Knowledge::Safe; }
+        bool isMine(int x, int y) const { return !m_board.isRevealed(x, y) && m_solver.get(x, y) == Solver::Knowledge::Mine; }
+
+    private:
+        // 把 Solver 新推出的结论转入查询用的列表
+        void collect();
+
+        const Board& m_board;
+        Solver m_solver;
+        bool m_settled = true;
+        // 候选安全格，从末尾取，失效的在取时丢弃
+        std::vector<int> m_safe;
+        std::vector<int> m_mines;
+        // 撤销或踩雷后 m_mines 中可能有失效或重复的格子
+        bool m_mines_dirty = false;
+        std::vector<int> m_covered;
+    };
+}
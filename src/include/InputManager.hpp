@@ -68,9 +68,13 @@ namespace Singleton {
         InputManager& operator=(const InputManager&) = delete;
 
     private:
+        auto isSameTarget(const IDCode id, sf::Vector2i a, sf::Vector2i b) const -> bool;
+
         ID m_id;
         std::unique_ptr<QuadTree::QuadTreeNode> root;
         std::unordered_map<std::type_index, std::vector<IDCode>> controls;
+        // 已登记的控件，用于判断两次按下是否落在同一个点击目标上
+        std::unordered_map<IDCode, const Base::Control::ControlBase*> targets;
         std::unique_ptr<sf::Clock> local_clock;
     };
 }
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <Board.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <vector>
+
+namespace Game {
+    // 撤销/重做日志，只保存每次操作的格子变化，不保存棋盘快照
+    // 变化按游程存储：下标连续且新旧状态相同的格子合并为一条 8 字节记录，大片连锁翻开通常每行只占几条
+    // 撤销和重做的开销与该次操作的变化量成正比
+    class Journal {
+    public:
+        // memory_cap 为已保存记录占用的字节上限，超出时丢弃最早的操作
+        explicit Journal(std::size_t memory_cap = std::size_t(16) << 20);
+
+        // 把 Board::getChanges() 追加到当前未结束的操作中，棋盘需开启变化记录
+        // 遇到整盘变化（重置、布雷）时清空全部历史，本次操作余下的变化也不再记录
+        void record(std::span<const CellChange> changes);
+        // 结束当前操作，空操作被忽略；产生新操作后重做历史作废
+        void commit();
+        void clear();
+
+        // 有未结束的操作（如分帧翻开尚未完成）时不能撤销或重做
+        bool canUndo() const { return m_open == 0 && !m_actions.empty(); }
+        bool canRedo() const { return m_open == 0 && !m_redo_actions.empty(); }
+        // 成功时返回 true，棋盘正在分帧翻开时返回 false
+        bool undo(Board& board);
+        bool redo(Board& board);
+
+        std::size_t getUndoCount() const { return m_actions.size(); }
+        std::size_t getRedoCount() const { return m_redo_actions.size(); }
+        std::size_t getMemory() const { return (m_runs.size() + m_redo_runs.size()) * sizeof(Run); }
+        std::size_t getMemoryCap() const { return m_memory_cap; }
+        void setMemoryCap(std::size_t memory_cap);
+
+    private:
+        // [start, start + length) 内的格子都从 before 变为 after
+        struct Run {
+            uint32_t start;
+            uint32_t length : 24;
+            uint32_t before : 4;
+            uint32_t after : 4;
+        };
+        static constexpr uint32_t MAX_RUN = (1u << 24) - 1;
+
+        void append(const CellChange& change);
+        // 丢弃最早的操作直到不超过上限，最近的一次操作总是保留
+        void trim();
+
+        std::size_t m_memory_cap;
+        // 已结束的操作按时间顺序首尾相接，m_actions 为每次操作的游程数
+        std::deque<Run> m_runs;
+        std::deque<std::size_t> m_actions;
+        // 当前操作已追加的游程数
+        std::size_t m_open = 0;
+        // 当前操作中出现过整盘变化
+        bool m_discard = false;
+        // 被撤销的操作，最近撤销的在末尾
+        std::vector<Run> m_redo_runs;
+        std::vector<std::size_t> m_redo_actions;
+    };
+}
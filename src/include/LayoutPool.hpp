@@ -0,0 +1,40 @@
+#pragma once
+
+#include <Board.hpp>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace Game {
+    // 在后台线程中预先布好雷的布局池
+    // 首次点击时取出一份，由 Board::adopt 按点击位置局部修补安全区
+    class LayoutPool {
+    public:
+        LayoutPool(int w, int h, int count, std::size_t capacity = 2);
+        ~LayoutPool();
+
+        LayoutPool(const LayoutPool&) = delete;
+        LayoutPool& operator=(const LayoutPool&) = delete;
+
+        // 取出一份已完成的布局，没有时立即返回空，由调用方同步生成
+        std::optional<Board> take();
+        // 唤醒后台线程把池子补满，对局结束或重置时调用
+        void refill();
+        std::size_t getReady();
+    private:
+        void run();
+
+        int m_width, m_height, m_count;
+        std::size_t m_capacity;
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::deque<Board> m_ready;
+        bool m_stop = false;
+        // 参数无效时不再尝试
+        bool m_failed = false;
+        std::thread m_worker;
+    };
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Game {
+    // 由雷的位平面（每行 stride 个 64 位字）计算每格周围的雷数
+    // 按 3x3 盒式求和（先纵向再横向）减去自身，SSE2 / AVX2 向量化，其他平台退回标量实现
+
+    // 结果以 4 位打包写入 nibbles（下标 y * width + x），zeros 非空时写入 "非雷且周围无雷" 的位平面
+    void count_mines(const uint64_t* mines, int width, int height, int stride, uint8_t* nibbles, uint64_t* zeros = nullptr);
+
+    // 结果每格一个字节写入 out（下标 y * width + x）
+    void count_mines_bytes(const uint64_t* mines, int width, int height, int stride, uint8_t* out);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <Board.hpp>
+#include <chrono>
+#include <optional>
+#include <stop_token>
+
+namespace Game {
+    struct NoGuessOptions {
+        // 工作线程数，0 表示使用全部核心
+        int workers = 0;
+        // 每个候选最多修补的次数，超过后丢弃重新布雷
+        int repairs = 24;
+        // 超时后返回空，由调用方退回普通布雷
+        std::chrono::milliseconds timeout{2000};
+        // 请求停止后同样尽快返回空，供在后台生成的调用方放弃等待
+        std::stop_token stop;
+    };
+
+    // 生成从 (px, py) 出发只靠 Solver 的推理（加上总雷数）就能完全解开的雷区
+    // 每个候选先由普通布雷得到，再模拟对局：卡住时把边界上的一个雷移到尚未接触的区域后重新模拟
+    // 各线程独立产生候选，任一线程找到后其余线程立即停止；超时或 options.stop 请求停止时返回空
+    // 修补后的布局不能由 BoardKey 复现，返回的 Board 的 hasKey() 为 false；尺寸或雷数无效时抛出 invalid_argument
+    std::optional<Board> make_no_guess_board(int w, int h, int count, int px, int py, const NoGuessOptions& options = {});
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <optional>
+
+namespace Game {
+    // 局部模式的推理结果缓存，键为 Solver 按模式计算的 Zobrist 哈希
+    // 固定大小、直接映射、新结果覆盖旧结果；各字段为原子量，多个线程的 Solver 可以共用一份
+    // 校验字由键和结果异或得到，读到被并发写入撕裂的条目时校验失败，按未命中处理
+    class PatternCache {
+    public:
+        // 结果为模式坐标系（以约束格为中心的 8x8 局部位图）中必定是雷 / 必定安全的格子
+        struct Result {
+            uint64_t mines;
+            uint64_t safe;
+        };
+
+        // 条目数向上取为 2 的幂
+        explicit PatternCache(std::size_t entries = std::size_t(1) << 16);
+
+        PatternCache(const PatternCache&) = delete;
+        PatternCache& operator=(const PatternCache&) = delete;
+
+        std::optional<Result> find(uint64_t key);
+        void store(uint64_t key, Result result);
+        void clear();
+
+        std::size_t getCapacity() const { return m_mask + 1; }
+        uint64_t getHits() const { return m_hits.load(std::memory_order_relaxed); }
+        uint64_t getMisses() const { return m_misses.load(std::memory_order_relaxed); }
+        void resetCounters();
+
+        // 以二进制格式保存 / 读入非空条目，读入的条目并入当前内容
+        // 模式编码改变时 FORMAT 随之改变，旧文件读入失败
+        bool save(std::ostream& out) const;
+        bool load(std::istream& in);
+
+        // 未另行指定时所有 Solver 共用的缓存
+        static PatternCache& shared();
+
+    private:
+        static constexpr uint32_t MAGIC = 0x4350534D;
+        static constexpr uint32_t FORMAT = 1;
+
+        struct Entry {
+            std::atomic<uint64_t> check{0};
+            std::atomic<uint64_t> mines{0};
+            std::atomic<uint64_t> safe{0};
+        };
+        static uint64_t checkOf(uint64_t key, Result result) { return key ^ result.mines ^ (result.safe * 0x9E3779B97F4A7C15ull); }
+
+        std::unique_ptr<Entry[]> m_entries;
+        std::size_t m_mask;
+        std::atomic<uint64_t> m_hits{0};
+        std::atomic<uint64_t> m_misses{0};
+    };
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <Board.hpp>
+#include <Solver.hpp>
+#include <cstdint>
+#include <stop_token>
+#include <vector>
+
+namespace Game {
+    // 每个未翻开格子是雷的精确概率，所有与已翻开数字一致、雷数等于总雷数的布局等可能
+    // 先用 Solver 排除确定的格子，剩下的边界格按共享的数字约束分成互不相干的分量
+    // 每个分量逐格枚举，剩余约束值相同的部分布局合并为一个状态，得到 "分量内 k 个雷" 的布局数及各格为雷的布局数
+    // 各分量再按总雷数做卷积，不在边界上的格子按组合数 C(R, M - k) 计权
+    // 分量之间并行求解；状态表超出上限的分量改用随机路径估计（Knuth 估计量），结果为近似值
+    class Probability {
+    public:
+        // stop 被请求时尽快返回，isCancelled() 为 true，结果不完整
+        void compute(const Board& board, std::stop_token stop = {});
+        bool isCancelled() const { return m_cancelled; }
+
+        // 已翻开的格子为 0，Solver 推出的雷为 1
+        double get(int x, int y) const { return m_probability[y * m_width + x]; }
+        const std::vector<double>& getProbabilities() const { return m_probability; }
+        // 是雷概率最小的未翻开格子，没有时返回 -1
+        int getSafest() const;
+
+        int getComponentCount() const { return static_cast<int>(m_components.size()); }
+        // 改用抽样估计的分量数
+        int getSampledCount() const { return m_sampled; }
+        // 边界之外的未知格数
+        int getInteriorCount() const { return m_interior; }
+
+        // 单个分量精确求解时状态表（状态数 x 雷数）的上限，超出后改为抽样
+        void setTableLimit(std::size_t entries) { m_table_limit = entries; }
+        // 抽样分量的随机路径条数
+        void setSamples(int samples) { m_samples = samples; }
+        // 边界格数达到该值时各分量改用多线程求解，小于 0 表示只用单线程
+        void setParallelThreshold(int cells) { m_parallel_threshold = cells; }
+
+    private:
+        struct Constraint {
+            // 分量内的格子序号，升序
+            int cells[8];
+            int size;
+            int mines;
+        };
+        struct Component {
+            std::vector<int> cells;
+            std::vector<Constraint> constraints;
+            // weights[k]：分量内恰有 k 个雷的布局数（按分量整体缩放）
+            std::vector<double> weights;
+            // mined[i * K + k]：其中第 i 格是雷的布局数，K = weights.size()
+            std::vector<double> mined;
+            bool sampled = false;
+        };
+        // 按格子顺序逐格赋值时需要的每层信息
+        struct Layout {
+            // 第 i 格所在的约束及赋值后该约束还剩几个未赋值的格子
+            std::vector<std::vector<std::pair<int, int>>> touch;
+            // 赋值第 i 格之前 / 之后仍未满足的约束，状态键按这个顺序每条占 4 位
+            std::vector<std::vector<int>> active;
+        };
+
+        // 由约束建立逐层信息，返回最多同时未满足的约束数
+        static int layout(const Component& component, Layout& layout);
+        // 枚举分量，状态表超出上限时返回 false
+        bool enumerate(Component& component, const Layout& layout, int max_mines) const;
+        void sample(Component& component, const Layout& layout, int max_mines, uint64_t seed) const;
+        void solveComponent(Component& component, int max_mines, uint64_t seed) const;
+        // 按总雷数合并各分量，写入边界格和内部格的概率
+        void combine(int mines);
+
+        int m_width = 0, m_height = 0;
+        std::stop_token m_stop;
+        bool m_cancelled = false;
+        Solver m_solver;
+        std::vector<double> m_probability;
+        std::vector<Component> m_components;
+        std::vector<int> m_interior_cells;
+        int m_interior = 0;
+        int m_sampled = 0;
+        std::size_t m_table_limit = std::size_t(1) << 22;
+        int m_samples = 1 << 14;
+        int m_parallel_threshold = 256;
+    };
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace Game {
+    // 可复现的 64 位随机数引擎，均满足 UniformRandomBitGenerator
+
+    // SplitMix64，也用于把一个种子展开为其他引擎的状态
+    class SplitMix64 {
+    public:
+        using result_type = uint64_t;
+        explicit SplitMix64(uint64_t seed = 0) : state(seed) {}
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+        result_type operator()() {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+
+        // 无状态混合，适合由坐标等直接得到哈希
+        static uint64_t mix(uint64_t value) { return SplitMix64(value)(); }
+    private:
+        uint64_t state;
+    };
+
+    // xoshiro256**
+    class Xoshiro256 {
+    public:
+        using result_type = uint64_t;
+        explicit Xoshiro256(uint64_t seed = 0) {
+            SplitMix64 sm(seed);
+            for (auto& word : s) word = sm();
+        }
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+        result_type operator()() {
+            const uint64_t result = std::rotl(s[1] * 5, 7) * 9;
+            const uint64_t t = s[1] << 17;
+            s[2] ^= s[0];
+            s[3] ^= s[1];
+            s[1] ^= s[2];
+            s[0] ^= s[3];
+            s[2] ^= t;
+            s[3] = std::rotl(s[3], 45);
+            return result;
+        }
+    private:
+        uint64_t s[4];
+    };
+
+    // PCG64（XSL RR 128/64），128 位乘法用 64 位拆分实现以便各编译器结果一致
+    class Pcg64 {
+    public:
+        using result_type = uint64_t;
+        explicit Pcg64(uint64_t seed = 0) {
+            SplitMix64 sm(seed);
+            uint64_t s_hi = sm(), s_lo = sm();
+            inc_hi = sm();
+            inc_lo = sm() | 1;
+            step();
+            add(state_hi, state_lo, s_hi, s_lo);
+            step();
+        }
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+        result_type operator()() {
+            step();
+            return std::rotr(state_hi ^ state_lo, static_cast<int>(state_hi >> 58));
+        }
+    private:
+        static constexpr uint64_t MUL_HI = 0x2360ED051FC65DA4ull;
+        static constexpr uint64_t MUL_LO = 0x4385DF649FCCF645ull;
+
+        static void add(uint64_t& hi, uint64_t& lo, uint64_t b_hi, uint64_t b_lo) {
+            lo += b_lo;
+            hi += b_hi + (lo < b_lo);
+        }
+        // 64x64 -> 128
+        static void mul64(uint64_t a, uint64_t b, uint64_t& hi, uint64_t& lo) {
+            uint64_t a_lo = a & 0xFFFFFFFF, a_hi = a >> 32;
+            uint64_t b_lo = b & 0xFFFFFFFF, b_hi = b >> 32;
+            uint64_t p0 = a_lo * b_lo, p1 = a_lo * b_hi, p2 = a_hi * b_lo, p3 = a_hi * b_hi;
+            uint64_t mid = (p0 >> 32) + (p1 & 0xFFFFFFFF) + (p2 & 0xFFFFFFFF);
+            lo = (mid << 32) | (p0 & 0xFFFFFFFF);
+            hi = p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
+        }
+        void step() {
+            uint64_t hi, lo;
+            mul64(state_lo, MUL_LO, hi, lo);
+            hi += state_lo * MUL_HI + state_hi * MUL_LO;
+            state_hi = hi;
+            state_lo = lo;
+            add(state_hi, state_lo, inc_hi, inc_lo);
+        }
+
+        uint64_t state_hi = 0, state_lo = 0;
+        uint64_t inc_hi = 0, inc_lo = 1;
+    };
+
+    enum class RandomKind : uint8_t {
+        SplitMix64,
+        Xoshiro256,
+        Pcg64,
+    };
+
+    // 不持有引擎的引用，把任意 64 位引擎传给非模板接口
+    class RandomRef {
+    public:
+        template <typename Engine>
+        requires (!std::same_as<std::remove_cvref_t<Engine>, RandomRef>)
+        RandomRef(Engine& engine)
+            : m_engine(&engine),
+            m_next([](void* e) -> uint64_t { return (*static_cast<Engine*>(e))(); })
+        {
+            static_assert(Engine::min() == 0 && Engine::max() == std::numeric_limits<uint64_t>::max(),
+                "RandomRef requires a full 64-bit engine");
+        }
+
+        uint64_t operator()() { return m_next(m_engine); }
+
+        // [0, n) 内均匀分布，不依赖标准库分布的实现，各平台结果一致
+        uint64_t below(uint64_t n) {
+            const uint64_t threshold = (0 - n) % n;
+            while (true) {
+                uint64_t x = (*this)();
+                if (x >= threshold) {
+                    return x % n;
+                }
+            }
+        }
+    private:
+        void* m_engine;
+        uint64_t (*m_next)(void*);
+    };
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <Board.hpp>
+#include <PatternCache.hpp>
+#include <cstdint>
+#include <span>
+#include <stop_token>
+#include <vector>
+
+namespace Game {
+    // 只依据已翻开的数字推理的确定性求解器，不看雷的位平面，也不信任玩家的旗子
+    // 每个数字格是一条约束：周围未知格中恰有 mines 个雷
+    // 未知格集合存为以约束格为中心的 8x8 局部位图，距离不超过 2 的两条约束平移到同一坐标系后
+    // 用一次 AND / POPCNT 比较，单条约束和子集/超集规则反复应用直到不再产生新结论
+    // 简单规则都无果时，把约束与距离 2 以内的约束作为一个局部模式一起枚举，结果按与位置无关的 Zobrist 键缓存
+    class Solver {
+    public:
+        enum class Knowledge : uint8_t {
+            Unknown,
+            Safe,
+            Mine,
+        };
+
+        // 重新求解，结果在下一次 solve 之前有效
+        // 所有约束先排队，最多推理 max_steps 条（小于 0 表示不限），余下的由 settle 继续；全部处理完时返回 true
+        // stop 被请求时尽快返回 false，此时结果不完整，需要重新 solve
+        bool solve(const Board& board, int max_steps = -1, std::stop_token stop = {});
+
+        // 增量接口：在上一次 solve 的基础上只处理变化的格子，之后调用 settle 推理
+        // 格子被翻开
+        void reveal(const Board& board, int x, int y);
+        // 翻开被撤销（棋盘上这些格子已恢复为未翻开），与它们相连的区域清除结论后重新推理
+        void cover(const Board& board, std::span<const int> cells);
+        // 处理排队的约束，最多 max_steps 条，小于 0 表示不限；全部处理完时返回 true，stop 被请求时返回 false
+        bool settle(int max_steps = -1, std::stop_token stop = {});
+
+        // 可证明安全 / 必定是雷的未翻开格子，按推出的顺序排列
+        // 增量更新时只追加，其中的格子之后可能已被翻开或结论被撤销，以 get() 为准
+        const std::vector<int>& getSafe() const { return m_safe; }
+        const std::vector<int>& getMines() const { return m_mines; }
+        void clearResults() {
+            m_safe.clear();
+            m_mines.clear();
+        }
+        // 已翻开的格子为 Safe
+        Knowledge get(int x, int y) const { return m_known[y * m_width + x]; }
+        // 推理过程中使用的约束条数
+        int getConstraintCount() const { return static_cast<int>(m_constraints.size() - m_free.size()); }
+
+        // 局部模式的推理缓存，默认为 PatternCache::shared()，nullptr 表示每次都重新枚举
+        void setCache(PatternCache* cache) { m_cache = cache; }
+        PatternCache* getCache() const { return m_cache; }
+
+    private:
+        // 8x8 局部位图中偏移 (dx, dy) 的位，中心位于第 3 行第 3 列，dx、dy 取 [-3, 3]
+        static constexpr int bitOf(int dx, int dy) { return (dy + 3) * 8 + dx + 3; }
+
+        struct Constraint {
+            int x, y;
+            uint64_t mask;
+            int mines;
+            bool queued;
+            bool pattern_queued;
+        };
+
+        // 以已翻开的数字格 (x, y) 建立约束
+        void addConstraint(const Board& board, int x, int y);
+        // 按当前结论重新计算约束的未知格和剩余雷数
+        void measure(const Board& board, Constraint& c) const;
+        void enqueue(int c);
+        // 按约束是否还有未知格更新活动位图
+        void setActive(const Constraint& c);
+        // 依次访问中心距 (x, y) 不超过 radius 且还有未知格的约束 f(cx, cy, c)，f 返回 false 时停止
+        template <typename F>
+        void forEachActive(int x, int y, int radius, F&& f) const;
+        // 局部模式可能改变的约束：中心距 (x, y) 不超过 radius
+        void enqueuePatterns(int x, int y, int radius);
+        // 记下一个结论并从周围约束中移除该格
+        void mark(int x, int y, Knowledge value);
+        // 格子的状态已确定，更新以它为邻的约束
+        void learn(int x, int y, Knowledge value);
+        // 把约束 c 局部位图中的格子全部标为 value
+        void markAll(const Constraint& c, uint64_t mask, Knowledge value);
+        // 对约束 c 应用单条约束规则和与附近约束的配对规则
+        void apply(int c);
+        // 把约束 c 与距离 2 以内的约束一起枚举，简单规则都无果时才调用
+        void applyPattern(int c);
+        // masks / mines 为模式中各约束在同一局部坐标系中的未知格和剩余雷数，cells 为它们的并集
+        // 返回所有满足这些约束的赋值中都是雷 / 都安全的格子
+        static PatternCache::Result enumerate(const uint64_t* masks, const int* mines, int size, uint64_t cells);
+
+        int m_width = 0, m_height = 0;
+        std::vector<Knowledge> m_known;
+        // 以该格为中心的约束编号，没有时为 -1
+        std::vector<int> m_constraint_at;
+        std::vector<Constraint> m_constraints;
+        // 还有未知格的约束中心，每行 m_active_stride 个字，邻域查询按字跳过空位
+        std::vector<uint64_t> m_active;
+        int m_active_stride = 0;
+        // 被撤销的约束留下的空位
+        std::vector<int> m_free;
+        std::vector<int> m_queue;
+        std::vector<int> m_pattern_queue;
+        // cover 遍历区域时的访问印记
+        std::vector<uint32_t> m_stamp;
+        uint32_t m_epoch = 0;
+        std::vector<int> m_region;
+        std::vector<int> m_safe;
+        std::vector<int> m_mines;
+        PatternCache* m_cache = &PatternCache::shared();
+    };
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+
+namespace Game::Topology {
+    // 邻居偏移
+    struct Offset {
+        int dx, dy, dz;
+    };
+
+    // 拓扑策略：DEGREE 个邻居，OFFSETS[y & 1] 为该行使用的偏移表
+    // WRAP 为真时坐标在各维上环绕，DEPTH 为真时使用第三维
+
+    // 经典方形网格，八邻域
+    struct Square8 {
+        static constexpr int DEGREE = 8;
+        static constexpr bool WRAP = false;
+        static constexpr bool DEPTH = false;
+        static constexpr std::array<Offset, DEGREE> ROW = {{
+            {-1, -1, 0}, {0, -1, 0}, {1, -1, 0},
+            {-1, 0, 0},              {1, 0, 0},
+            {-1, 1, 0},  {0, 1, 0},  {1, 1, 0},
+        }};
+        static constexpr std::array<std::array<Offset, DEGREE>, 2> OFFSETS = {ROW, ROW};
+    };
+
+    // 六边形网格，奇数行右移半格（odd-r）
+    struct Hex6 {
+        static constexpr int DEGREE = 6;
+        static constexpr bool WRAP = false;
+        static constexpr bool DEPTH = false;
+        static constexpr std::array<std::array<Offset, DEGREE>, 2> OFFSETS = {{
+            {{{-1, -1, 0}, {0, -1, 0}, {-1, 0, 0}, {1, 0, 0}, {-1, 1, 0}, {0, 1, 0}}},
+            {{{0, -1, 0}, {1, -1, 0}, {-1, 0, 0}, {1, 0, 0}, {0, 1, 0}, {1, 1, 0}}},
+        }};
+    };
+
+    // 上下、左右环绕的方形网格
+    struct Torus8 {
+        static constexpr int DEGREE = 8;
+        static constexpr bool WRAP = true;
+        static constexpr bool DEPTH = false;
+        static constexpr std::array<std::array<Offset, DEGREE>, 2> OFFSETS = Square8::OFFSETS;
+    };
+
+    // W x H x D 立方网格，26 邻域
+    struct Cube26 {
+        static constexpr int DEGREE = 26;
+        static constexpr bool WRAP = false;
+        static constexpr bool DEPTH = true;
+        static constexpr std::array<Offset, DEGREE> ROW = [] {
+            std::array<Offset, DEGREE> offsets{};
+            int n = 0;
+            for (int dz = -1; dz <= 1; ++dz) {
+                for (int dy = -1; dy <= 1; ++dy) {
+                    for (int dx = -1; dx <= 1; ++dx) {
+                        if (dx || dy || dz) offsets[n++] = {dx, dy, dz};
+                    }
+                }
+            }
+            return offsets;
+        }();
+        static constexpr std::array<std::array<Offset, DEGREE>, 2> OFFSETS = {ROW, ROW};
+    };
+}
@@ -12,8 +12,10 @@
 #include <SFML/System/Vector2.hpp>
 #include <SFML/Window/Event.hpp>
 #include <cstdio>
+#include <cwchar>
 #include <functional>
 #include <memory>
+#include <string>
 
 const int Beginner_para[] = {9, 9, 10};
 const int Intermediate_para[] = {16, 16, 40};
@@ -21,11 +23,18 @@ const int Expert_para[] = {16, 30, 99};
 
 const auto& current_para = Intermediate_para;
 
+// 每帧留给分帧翻开的时间，144 Hz 下一帧约 6.9 ms
+const sf::Time reveal_budget = sf::milliseconds(4);
+
+const char* const window_title = "CMake SFML Project";
+
 void game_state_callback(std::shared_ptr<const Base::MessageBase> message);
+// 当前模式显示在窗口标题上
+void update_title(sf::RenderWindow& window, const Game::CellCoord& cell_coord);
 
 int main()
 {
-    auto window = sf::RenderWindow(sf::VideoMode({current_para[0]*30u, current_para[1]*30u}), "CMake SFML Project");
+    auto window = sf::RenderWindow(sf::VideoMode({current_para[0]*30u, current_para[1]*30u}), window_title);
     window.setFramerateLimit(144);
     auto& message_bus = Singleton::MessageBus::getInstance();
     auto& input_manager = Singleton::InputManager::getInstance();
@@ -77,15 +86,15 @@ int main()
         }
     });
 
-    for(auto& cell: cell_coord.m_cells) {
-        input_manager.enrol(cell, typeid(Message::ClickEvent));
-        message_bus.subscribe(cell.getCode(), 
-        std::function<void(std::shared_ptr<const Message::ClickEvent>)>{
-            [&cell](std::shared_ptr<const Message::ClickEvent> message) {
-                cell.OnClicked(message);
-            }
-        });
-    }
+    // 每个 ID 只能有一个回调，单击和双击共用一个，由 OnClicked 按类型分发
+    input_manager.enrol(cell_coord, typeid(Message::ClickEvent));
+    input_manager.enrol(cell_coord, typeid(Message::DClickEvent));
+    message_bus.subscribe(cell_coord.getCode(), 
+    std::function<void(std::shared_ptr<const Base::MessageBase>)>{
+        [&cell_coord](std::shared_ptr<const Base::MessageBase> message) {
+            cell_coord.OnClicked(message);
+        }
+    });
 
     while (window.isOpen())
     {
@@ -95,11 +104,44 @@ int main()
             {
                 window.close();
             }
+            // Ctrl+Z 撤销，Ctrl+Y 重做，H 切换分析叠加层，G 切换免猜布雷，E 切换无尽模式，方向键移动无尽模式的镜头
+            // T 切换拓扑变体，三维棋盘上用上下方向键换层
+            if (const auto* key = event->getIf<sf::Event::KeyPressed>(); key && key->control) {
+                if (key->code == sf::Keyboard::Key::Z) {
+                    cell_coord.undo();
+                } else if (key->code == sf::Keyboard::Key::Y) {
+                    cell_coord.redo();
+                }
+            } else if (key && key->code == sf::Keyboard::Key::H) {
+                cell_coord.cycleOverlay();
+            } else if (key && key->code == sf::Keyboard::Key::G) {
+                cell_coord.setNoGuess(!cell_coord.isNoGuess());
+                update_title(window, cell_coord);
+            } else if (key && key->code == sf::Keyboard::Key::E) {
+                cell_coord.setEndless(!cell_coord.isEndless());
+                update_title(window, cell_coord);
+            } else if (key && key->code == sf::Keyboard::Key::T) {
+                cell_coord.cycleVariant();
+                update_title(window, cell_coord);
+            } else if (key && cell_coord.getVariant() == Game::BoardVariant::Cube
+                && (key->code == sf::Keyboard::Key::Up || key->code == sf::Keyboard::Key::Down)) {
+                cell_coord.stepLayer(key->code == sf::Keyboard::Key::Up ? -1 : 1);
+                update_title(window, cell_coord);
+            } else if (key && cell_coord.isEndless()) {
+                switch (key->code) {
+                    case sf::Keyboard::Key::Left: cell_coord.pan(-1, 0); break;
+                    case sf::Keyboard::Key::Right: cell_coord.pan(1, 0); break;
+                    case sf::Keyboard::Key::Up: cell_coord.pan(0, -1); break;
+                    case sf::Keyboard::Key::Down: cell_coord.pan(0, 1); break;
+                    default: break;
+                }
+            }
             
             input_manager.handle(event);
         }
 
         message_bus.handle();
+        cell_coord.update(reveal_budget);
         window.clear();
         window.draw(cell_coord);
         window.display();
@@ -108,21 +150,46 @@ int main()
 
 #include <windows.h>
 
+// 已完成的 3BV 和 3BV/s
+std::wstring summary_text(const Game::GameSummary& summary) {
+    wchar_t text[64];
+    std::swprintf(text, 64, L"3BV: %d/%d  3BV/s: %.2f\n", summary.solved_bbbv, summary.bbbv, summary.getBBBVPerSecond());
+    return text;
+}
+
+void update_title(sf::RenderWindow& window, const Game::CellCoord& cell_coord) {
+    std::string title = window_title;
+    if (cell_coord.isEndless()) {
+        title += " - Endless";
+    } else if (cell_coord.getVariant() == Game::BoardVariant::Hex) {
+        title += " - Hex";
+    } else if (cell_coord.getVariant() == Game::BoardVariant::Torus) {
+        title += " - Torus";
+    } else if (cell_coord.getVariant() == Game::BoardVariant::Cube) {
+        title += " - Cube layer " + std::to_string(cell_coord.getLayer() + 1) + "/" + std::to_string(Game::CellCoord::CUBE_DEPTH);
+    } else if (cell_coord.isNoGuess()) {
+        title += " - No-guess";
+    }
+    window.setTitle(title);
+}
+
 void game_state_callback(std::shared_ptr<const Base::MessageBase> message) {
     std::printf("Game end\n");
     auto event_code = message->getTypeIndex();
     int result = 0;
     if (event_code == typeid(Message::GameWin)) {
+        const auto& summary = std::static_pointer_cast<const Message::GameWin>(message)->summary;
         result = MessageBoxW(
             NULL,
-            L"恭喜你获胜!\n点击YES重开一局\n点击NO来退出",
+            (L"恭喜你获胜!\n" + summary_text(summary) + L"点击YES重开一局\n点击NO来退出").c_str(),
             L"胜利",
             MB_YESNO | MB_SYSTEMMODAL 
         );
     } else if (event_code == typeid(Message::GameOver)) {
+        const auto& summary = std::static_pointer_cast<const Message::GameOver>(message)->summary;
         result = MessageBoxW(
             NULL,
-            L"很遗憾你失败了...\n点击YES来重开一局\n点击NO来退出",
+            (L"很遗憾你失败了...\n" + summary_text(summary) + L"点击YES来重开一局\n点击NO来退出").c_str(),
             L"失败",
             MB_YESNO | MB_SYSTEMMODAL 
         );